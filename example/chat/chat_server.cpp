@@ -1,6 +1,10 @@
 #include "common/server.h"
 #include "xynet/coroutine/single_consumer_async_auto_reset_event.h"
 #include "xynet/stream_buffer.h"
+#include "xynet/socket/deadline.h"
+#include "xynet/socket/read_until.h"
+#include "xynet/object_slab.h"
+#include "xynet/shared_buffer.h"
 #include <deque>
 #include <stop_token>
 #include <unordered_set>
@@ -12,12 +16,14 @@ using namespace std;
 using namespace xynet;
 
 inline constexpr static std::size_t MAX_MESSAGE_LEN = 1024;
+inline constexpr static auto IDLE_TIMEOUT = chrono::minutes{5};
+inline constexpr static std::size_t MAX_SESSIONS = 10000;
 
 class chat_room;
 class chat_session_interface;
 
-using message_t = vector<byte>;
-using message_ptr = shared_ptr<message_t>;
+// one allocation per message, shared by the send queues of the whole room without atomics.
+using message_ptr = shared_buffer;
 using chat_session_ptr = chat_session_interface*;
 
 struct chat_session_interface
@@ -50,11 +56,7 @@ public:
     auto welcome_str = "|        SERVER       |:"s 
       + participant->get_address().to_str() + " has joined the chat\n"s;
     
-    auto welcome_message_ptr = make_shared<vector<byte>>(welcome_str.size());
-    copy(
-      reinterpret_cast<byte*>(&*welcome_str.begin()), 
-      reinterpret_cast<byte*>(&*(welcome_str.begin() + welcome_str.size())), 
-      welcome_message_ptr->begin());
+    auto welcome_message_ptr = shared_buffer{as_bytes(span{welcome_str})};
 
     for(auto participant : m_participants)
     {
@@ -67,11 +69,7 @@ public:
     auto farewell_str = "|        SERVER       |:"s 
       + participant->get_address().to_str() + " has left the chat\n"s;
     
-    auto farewell_message_ptr = make_shared<vector<byte>>(farewell_str.size());
-    copy(
-      reinterpret_cast<byte*>(&*farewell_str.begin()), 
-      reinterpret_cast<byte*>(&*(farewell_str.begin() + farewell_str.size())), 
-      farewell_message_ptr->begin());
+    auto farewell_message_ptr = shared_buffer{as_bytes(span{farewell_str})};
 
     for(auto participant : m_participants)
     {
@@ -106,16 +104,17 @@ private:
 class chat_session : public chat_session_interface
 {
 public:
-  chat_session(socket_t peer_socket, chat_room& room)
+  chat_session(socket_t peer_socket, chat_room& room, deadline_list& idle_deadlines)
   :m_socket{std::move(peer_socket)}
   ,m_room{room}
+  ,m_idle_deadline{idle_deadlines, m_socket}
   {
     make_message_head();
   }
 
   void deliver(message_ptr message) override
   {
-    m_write_msgs.push_back(message);
+    m_socket.enqueue(std::move(message));
     m_event.set();
   }
 
@@ -150,15 +149,14 @@ private:
     {
       while(!token.stop_requested())
       {
-        if(m_write_msgs.empty())
+        if(m_socket.send_queue_empty())
         {
           co_await m_event;
         }
         else
         {
           [[maybe_unused]]
-          auto sent_bytes = co_await m_socket.send(*m_write_msgs.front());
-          m_write_msgs.pop_front();
+          auto sent_bytes = co_await m_socket.flush();
         }
       }
     }catch(...)
@@ -167,27 +165,13 @@ private:
     }
   }
 
-  auto message_parser(string_view str)
+  auto deliver_message(span<const byte> line)
   {
-    auto pos = str.find('\n');
-    if(pos == string_view::npos)
-    {
-      return std::size_t{};
-    }
-
-    auto message = make_shared<vector<byte>>();
-    message->reserve(pos + 1 + m_message_head.size());
-    copy(
-      reinterpret_cast<const byte*>(&*m_message_head.begin()), 
-      reinterpret_cast<const byte*>(&*(m_message_head.begin() + m_message_head.size())),
-      back_inserter(*message));
-    copy(
-      reinterpret_cast<const byte*>(&*str.data()), 
-      reinterpret_cast<const byte*>(&*(str.data() + pos + 1)),
-      back_inserter(*message));
-    m_room.deliver(message);
-
-    return pos + 1;
+    auto head = as_bytes(span{m_message_head});
+    auto message = shared_buffer{head.size() + line.size()};
+    auto out = copy(head.begin(), head.end(), message.writable().begin());
+    copy(line.begin(), line.end(), out);
+    m_room.deliver(std::move(message));
   }
 
   auto reader(stop_token token) -> task<>
@@ -197,19 +181,11 @@ private:
     {
       for(;!token.stop_requested();)
       {
-        auto buf = sbuf.prepare(1024u);
-        auto read_bytes = co_await m_socket.recv_some(buf);
-        sbuf.commit(read_bytes);
-        while(true)
-        {
-          auto num_parsed = message_parser(sbuf.data_string_view());
-          if(num_parsed == 0)
-          {
-            break;
-          }
-          sbuf.consume(num_parsed);
-        }
-
+        // a line that is still incomplete is not scanned again after every recv.
+        auto line = co_await read_until(m_socket, sbuf, "\n", MAX_MESSAGE_LEN);
+        m_idle_deadline.refresh();
+        deliver_message(line);
+        sbuf.consume(line.size());
       }
     }catch(...)
     {
@@ -233,8 +209,9 @@ private:
 
   socket_t m_socket;
   chat_room& m_room;
+  // a session that sends nothing for IDLE_TIMEOUT has its recv canceled and is stopped.
+  connection_deadline m_idle_deadline;
   string m_message_head;
-  deque<message_ptr> m_write_msgs;
   single_consumer_async_auto_reset_event m_event;
   stop_source m_stop_source;
 };
@@ -243,12 +220,28 @@ int main()
 {
   auto service = io_service{};
   auto room = chat_room{};
-  sync_wait(start_server([&room](socket_t peer_socket) -> task<>
-  {
-    auto session = chat_session{std::move(peer_socket), room};
-    co_await session.start();
+  auto idle_deadlines = deadline_list{service, IDLE_TIMEOUT, chrono::seconds{1}};
+  // admission control keeps the sessions below MAX_SESSIONS, so a session never waits for a record.
+  auto sessions = object_slab<chat_session>{MAX_SESSIONS};
+  // every message fans out to the whole room, so shed joiners before the room gets slow.
+  auto admission = admission_options
+  {
+    .max_connections = MAX_SESSIONS,
+    .accept_rate     = 2000,
+    .accept_burst    = 256,
+    .max_loop_lag    = chrono::milliseconds{20},
+    .shed_response   = "server busy, try again later.\n"
+  };
+  sync_wait(when_all(start_server([&room, &idle_deadlines, &sessions](socket_t peer_socket) -> task<>
+  {
+    auto session = sessions.try_make(std::move(peer_socket), room, idle_deadlines);
+    if(!session)
+    {
+      co_return;
+    }
+    co_await session->start();
     co_return;
-  }, service, 25565));
+  }, service, 25565, socket_profile{}, admission), idle_deadlines.run(stop_token{})));
 }
 
 
@@ -1,5 +1,6 @@
 #include "common/server.h"
 #include "xynet/file/file.h"
+#include "xynet/file/send_file.h"
 #include "xynet/buffer.h"
 #include "xynet/stream_buffer.h"
 #include <chrono>
@@ -19,10 +20,8 @@ auto file_transfer(socket_t peer_socket, std::string_view path) -> task<>
   {
     co_await file.openat(path, O_RDONLY, 0u);
     co_await file.update_statx();
-    auto buffer = vector<byte>(file.file_size());
-    co_await file.read_some(buffer);
     [[maybe_unused]]
-    auto sent_bytes = co_await peer_socket.send(buffer);
+    auto sent_bytes = co_await send_file(file, peer_socket, 0, file.file_size());
   }catch(const exception& ex)
   {
     puts(ex.what());
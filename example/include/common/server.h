@@ -1,26 +1,38 @@
 #include <concepts>
+#include <unistd.h>
 
 #include "xynet/io_service.h"
 #include "xynet/socket/socket.h"
+#include "xynet/socket/admission_control.h"
 
 #include "xynet/coroutine/task.h"
 #include "xynet/coroutine/when_all.h"
 #include "xynet/coroutine/sync_wait.h"
 #include "xynet/coroutine/async_scope.h"
 
+// keeps the admission ticket of the peer until the client is done with it.
+auto serve_admitted(auto client, auto peer_socket, xynet::admission_control::ticket ticket)
+-> xynet::task<>
+{
+  co_await client(std::move(peer_socket));
+}
+
 auto acceptor(auto client,
               xynet::io_service& service,
-              uint16_t port) 
+              uint16_t port,
+              const xynet::socket_profile& profile,
+              const xynet::admission_options& admission_options)
 -> xynet::task<>
 {
   auto scope = xynet::async_scope{};
+  auto admission = xynet::admission_control{service, admission_options};
   auto listen_socket = xynet::socket_t{};
   auto ex = std::exception_ptr{};
 
   try
   {
     listen_socket.init();
-    listen_socket.reuse_address();
+    listen_socket.apply_listener_profile(profile);
     listen_socket.bind(xynet::socket_address{port});
     listen_socket.listen();
 
@@ -28,6 +40,59 @@ auto acceptor(auto client,
     {
       auto peer_socket = xynet::socket_t{};
       co_await listen_socket.accept(peer_socket);
+      auto ticket = admission.try_admit();
+      if(!ticket)
+      {
+        // closed when peer_socket goes out of scope.
+        admission.shed(peer_socket.get());
+        continue;
+      }
+      // a peer that fails to take the options is still served.
+      auto error = std::error_code{};
+      peer_socket.apply_accepted_profile(profile, error);
+      scope.spawn(serve_admitted(client, std::move(peer_socket), std::move(ticket)));
+    }
+  }
+  catch(...)
+  {
+    ex = std::current_exception();
+  }
+
+  co_await scope.join();
+  service.request_stop();
+
+  if(ex)
+  {
+    std::rethrow_exception(ex);
+  }
+
+  co_return;
+}
+
+auto unix_acceptor(auto client,
+                   xynet::io_service& service,
+                   const xynet::unix_socket_address& address)
+-> xynet::task<>
+{
+  auto scope = xynet::async_scope{};
+  auto listen_socket = xynet::unix_stream_socket_t{};
+  auto ex = std::exception_ptr{};
+
+  try
+  {
+    if(!address.is_abstract())
+    {
+      // a stale socket file from a previous run makes bind fail with EADDRINUSE.
+      ::unlink(address.to_str().c_str());
+    }
+    listen_socket.init();
+    listen_socket.bind(address);
+    listen_socket.listen();
+
+    for(;;)
+    {
+      auto peer_socket = xynet::unix_stream_socket_t{};
+      co_await listen_socket.accept(peer_socket);
       scope.spawn(client(std::move(peer_socket)));
     }
   }
@@ -55,12 +120,27 @@ auto start_service(xynet::io_service& service)
 }
 
 auto start_server(auto client, 
-xynet::io_service& service, uint16_t port)
+xynet::io_service& service, uint16_t port,
+const xynet::socket_profile& profile = xynet::socket_profile{},
+const xynet::admission_options& admission = xynet::admission_options{})
+-> xynet::task<>
+{
+  co_await xynet::when_all
+  (
+    acceptor(client, service, port, profile, admission),
+    start_service(service)
+  );
+
+  co_return;
+}
+
+auto start_unix_server(auto client,
+xynet::io_service& service, const xynet::unix_socket_address& address)
 -> xynet::task<>
 {
   co_await xynet::when_all
   (
-    acceptor(client, service, port),
+    unix_acceptor(client, service, address),
     start_service(service)
   );
 
@@ -3,6 +3,8 @@
 #include <stop_token>
 #include <numeric>
 #include <algorithm>
+#include <string_view>
+#include <type_traits>
 
 using namespace std;
 using namespace xynet;
@@ -14,11 +16,14 @@ struct pingpong_config
   chrono::milliseconds timeout;
 };
 
+/// \brief Socket is socket_t over TCP or unix_stream_socket_t over AF_UNIX,
+///        Address is the matching socket_address or unix_socket_address.
+template<typename Socket, typename Address>
 class pingpong_client
 {
 public:
   pingpong_client(io_service& service, 
-                  const socket_address& address, 
+                  const Address& address, 
                   const pingpong_config& config)
   :m_service{service}
   ,m_address{address}
@@ -27,12 +32,16 @@ public:
 
   auto session(stop_token token) -> task<double>
   {
-    auto s = socket_t{};
+    auto s = Socket{};
     auto buffer = vector<byte>(m_config.message_len);
     auto total_bytes_read = double{};
     try
     {
       s.init();
+      if constexpr(is_same_v<Address, socket_address>)
+      {
+        s.apply_connection_profile(socket_profile::low_latency());
+      }
       co_await s.connect(m_address);    
       while(!token.stop_requested())
       {
@@ -86,7 +95,7 @@ public:
   }
 private:
   io_service&            m_service;
-  const socket_address&  m_address;
+  const Address&         m_address;
   const pingpong_config& m_config;
 };
 
@@ -94,7 +103,7 @@ int main(int argc, char** argv)
 {
   if(argc != 6)
   {
-    puts("usage: pingpong_client [destination] [port] [client number] [message length bytes] [timeout seconds]");
+    puts("usage: pingpong_client [destination | unix:path] [port] [client number] [message length bytes] [timeout seconds]");
     return 0;
   }
   auto dst = string{};
@@ -119,16 +128,30 @@ int main(int argc, char** argv)
   auto config 
     = pingpong_config{.client_num = num, .message_len = len, .timeout = timeout};
   auto service = io_service{};
-  auto address = socket_address{dst, port};
-  auto client = pingpong_client(service, address, config);
+  auto run = [&service](auto& client)
+  {
+    sync_wait(when_all
+    (
+      client.run(),
+      [&service]() -> task<>
+      {
+        service.run();
+        co_return;
+      }()
+    ));
+  };
 
-  sync_wait(when_all
-  (
-    client.run(),
-    [&service]() -> task<>
-    {
-      service.run();
-      co_return;
-    }()
-  ));
+  if(dst.starts_with("unix:"))
+  {
+    // the port is ignored for Unix domain sockets.
+    auto address = unix_socket_address{string_view{dst}.substr(5)};
+    auto client = pingpong_client<unix_stream_socket_t, unix_socket_address>(service, address, config);
+    run(client);
+  }
+  else
+  {
+    auto address = socket_address{dst, port};
+    auto client = pingpong_client<socket_t, socket_address>(service, address, config);
+    run(client);
+  }
 }
\ No newline at end of file
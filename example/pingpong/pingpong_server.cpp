@@ -1,14 +1,17 @@
 #include "common/server.h"
-#include <vector>
+#include "xynet/buffer_pool.h"
+#include <optional>
+#include <string_view>
 
 using namespace std;
 using namespace xynet;
 
 inline static size_t PINGPONG_BUFFER_SIZE = size_t{};
 
-auto pingpong_server(socket_t peer_socket) -> task<>
+// generic over the socket type so the same handler serves TCP and Unix domain peers.
+inline constexpr auto pingpong_server = [](auto peer_socket) -> task<>
 {
-  auto buf = vector<byte>(PINGPONG_BUFFER_SIZE);
+  auto buf = buffer_pool::local().allocate(PINGPONG_BUFFER_SIZE);
   try
   {
     for(;;)
@@ -24,23 +27,28 @@ auto pingpong_server(socket_t peer_socket) -> task<>
     peer_socket.shutdown();
     co_await peer_socket.close();
   }catch(...){}
-
-}
+};
 
 int main(int argc, char** argv)
 {
   if(argc != 3)
   {
-    puts("usage: pingpong_server [port] [message length bytes]");
+    puts("usage: pingpong_server [port | unix:path] [message length bytes]");
     return 0;
   }
 
+  auto endpoint = string_view{argv[1]};
+  auto unix_path = endpoint.starts_with("unix:") 
+    ? optional{endpoint.substr(5)} : nullopt;
   auto port = uint16_t{};
   auto len  = size_t{};
 
   try
   {
-    port = static_cast<uint16_t>(stoi(string(argv[1])));
+    if(!unix_path)
+    {
+      port = static_cast<uint16_t>(stoi(string(endpoint)));
+    }
     len = stoi(string(argv[2]));
   }catch(const exception& ex)
   {
@@ -51,7 +59,14 @@ int main(int argc, char** argv)
   PINGPONG_BUFFER_SIZE = len;
   
   auto service = io_service{};
-  sync_wait(start_server(pingpong_server, service, port));
+  if(unix_path)
+  {
+    sync_wait(start_unix_server(pingpong_server, service, unix_socket_address{*unix_path}));
+  }
+  else
+  {
+    sync_wait(start_server(pingpong_server, service, port, socket_profile::low_latency()));
+  }
 }
 
 
@@ -0,0 +1,160 @@
+// A pingpong server with one SO_REUSEPORT listener and one io_service per thread, thread i
+// pinned to cpu i, to compare how the kernel spreads the connections over the listeners.
+//
+//   hash  the default SO_REUSEPORT hash of the 4-tuple, blind to the receiving cpu.
+//   steer reuse_port_cpu_steering(), the listener of the receiving cpu.
+//
+// Every 5 seconds it prints, per thread, the connections accepted and how many of them
+// were received on the cpu of the thread(SO_INCOMING_CPU). To see the cost of the
+// connections that cross cpus, run the same load against both modes under
+//
+//   perf stat -e cache-misses,LLC-load-misses -p $(pidof reuseport_server) -- sleep 10
+//
+// with e.g. pingpong_client 127.0.0.1 [port] 512 64 10, and with the NIC queues(or RPS)
+// spread over the same cpus as the threads.
+
+#include "common/server.h"
+#include "xynet/buffer_pool.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+
+using namespace std;
+using namespace xynet;
+
+inline static size_t PINGPONG_BUFFER_SIZE = size_t{};
+
+struct listener_stats
+{
+  atomic<size_t> accepted{0};
+  atomic<size_t> local{0};
+};
+
+auto pingpong_session(socket_t peer_socket) -> task<>
+{
+  auto buf = buffer_pool::local().allocate(PINGPONG_BUFFER_SIZE);
+  try
+  {
+    for(;;)
+    {
+      auto recv_bytes = co_await peer_socket.recv_some(buf);
+      [[maybe_unused]]
+      auto sent_bytes = co_await peer_socket.send(span{buf.begin(), recv_bytes});
+    }
+  }catch(...){}
+
+  try
+  {
+    peer_socket.shutdown();
+    co_await peer_socket.close();
+  }catch(...){}
+}
+
+auto incoming_cpu_of(const socket_t& socket) -> int
+{
+  auto cpu = int{-1};
+  auto len = socklen_t{sizeof(cpu)};
+  ::getsockopt(socket.get(), SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len);
+  return cpu;
+}
+
+auto serve(socket_t& listen_socket, int cpu, listener_stats& stats) -> task<>
+{
+  auto scope = async_scope{};
+  for(;;)
+  {
+    auto peer_socket = socket_t{};
+    auto error = std::error_code{};
+    co_await listen_socket.accept(peer_socket, error);
+    if(error)
+    {
+      break;
+    }
+
+    stats.accepted.fetch_add(1, memory_order_relaxed);
+    if(incoming_cpu_of(peer_socket) == cpu)
+    {
+      stats.local.fetch_add(1, memory_order_relaxed);
+    }
+    auto ignored = std::error_code{};
+    peer_socket.apply_accepted_profile(socket_profile::low_latency(), ignored);
+    scope.spawn(pingpong_session(std::move(peer_socket)));
+  }
+  co_await scope.join();
+}
+
+int main(int argc, char** argv)
+{
+  if(argc != 5)
+  {
+    puts("usage: reuseport_server [port] [threads] [message length bytes] [hash | steer]");
+    return 0;
+  }
+
+  auto port    = uint16_t{};
+  auto threads = unsigned{};
+  auto steer   = string_view{argv[4]} == "steer";
+  try
+  {
+    port    = static_cast<uint16_t>(stoi(string(argv[1])));
+    threads = static_cast<unsigned>(stoi(string(argv[2])));
+    PINGPONG_BUFFER_SIZE = stoi(string(argv[3]));
+  }catch(const exception& ex)
+  {
+    puts(ex.what());
+    return 0;
+  }
+
+  // the listeners are bound in order, listener i is the index i of the reuseport group.
+  auto profile = socket_profile::low_latency();
+  profile.reuse_port = true;
+  auto listeners = vector<socket_t>(threads);
+  for(auto& listener : listeners)
+  {
+    listener.init();
+    listener.apply_listener_profile(profile);
+    listener.bind(socket_address{port});
+    listener.listen();
+  }
+  if(steer)
+  {
+    listeners.front().reuse_port_cpu_steering(threads);
+  }
+
+  auto stats = make_unique<listener_stats[]>(threads);
+  auto workers = vector<jthread>{};
+  for(auto i = 0u; i < threads; ++i)
+  {
+    workers.emplace_back([&listeners, &stats, i]()
+    {
+      auto cpus = cpu_set_t{};
+      CPU_ZERO(&cpus);
+      CPU_SET(i, &cpus);
+      ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus);
+
+      auto service = io_service{};
+      sync_wait(when_all(serve(listeners[i], static_cast<int>(i), stats[i]), start_service(service)));
+    });
+  }
+
+  printf("listening on port %u with %u threads, %s\n", port, threads, steer ? "steered by cpu" : "hashed");
+  fflush(stdout);
+  for(;;)
+  {
+    this_thread::sleep_for(chrono::seconds{5});
+    for(auto i = 0u; i < threads; ++i)
+    {
+      auto accepted = stats[i].accepted.load(memory_order_relaxed);
+      auto local    = stats[i].local.load(memory_order_relaxed);
+      printf("cpu %u: %zu connections, %zu received on this cpu(%.1f%%)\n", i, accepted, local,
+             accepted == 0 ? 0. : 100. * static_cast<double>(local) / static_cast<double>(accepted));
+    }
+    fflush(stdout);
+  }
+}
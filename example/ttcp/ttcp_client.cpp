@@ -16,6 +16,7 @@ auto ttcp_client(io_service& service,
   try
   {
     s.init();
+    s.apply_connection_profile(socket_profile::bulk());
     co_await s.connect(address);
 
     message.length = ::htonl(message.length);
@@ -43,7 +44,7 @@ auto ttcp_client(io_service& service,
     for(std::size_t i = 0; i < ::ntohl(message.number); ++i)
     {
       std::printf("sending %lu: %lu bytes\n", i, ttcp_payload_bytes);
-      sent_bytes = co_await s.send(span{reinterpret_cast<byte*>(ttcp_payload.get()), ttcp_payload_bytes});
+      sent_bytes = co_await s.send_zc(span{reinterpret_cast<byte*>(ttcp_payload.get()), ttcp_payload_bytes});
       std::printf("sent %lu\n", sent_bytes);
       auto ack = int32_t{};
       [[maybe_unused]]
@@ -91,6 +91,6 @@ int main(int argc, char** argv)
  }
  
  auto service = io_service{};
- sync_wait(start_server(ttcp_server, service, port));
+ sync_wait(start_server(ttcp_server, service, port, socket_profile::bulk()));
  return 0;
 }
\ No newline at end of file
@@ -21,6 +21,21 @@ using message_t   = vector<byte>;
 using message_ptr = shared_ptr<message_t>;
 using chat_session_ptr = chat_session_interface*;
 
+// the frame of a message is encoded once and shared by the send queues of all the participants.
+auto make_text_frame(const message_t& payload) -> message_ptr
+{
+  auto header = websocket_frame_header
+  {
+    websocket_flags::WS_FINAL_FRAME
+  | websocket_flags::WS_OP_TEXT,
+    payload.size()};
+  auto frame = make_shared<message_t>();
+  frame->reserve(header.span().size() + payload.size());
+  frame->insert(frame->end(), header.span().begin(), header.span().end());
+  frame->insert(frame->end(), payload.begin(), payload.end());
+  return frame;
+}
+
 struct chat_session_interface
 {
   virtual void deliver(message_ptr message) = 0;
@@ -57,9 +72,10 @@ public:
       reinterpret_cast<byte*>(&*(welcome_str.begin() + welcome_str.size())), 
       welcome_message_ptr->begin());
 
+    auto welcome_frame_ptr = make_text_frame(*welcome_message_ptr);
     for(auto participant : m_participants)
     {
-      participant->deliver(welcome_message_ptr);
+      participant->deliver(welcome_frame_ptr);
     }
   }
 
@@ -74,9 +90,10 @@ public:
       reinterpret_cast<byte*>(&*(farewell_str.begin() + farewell_str.size())), 
       farewell_message_ptr->begin());
 
+    auto farewell_frame_ptr = make_text_frame(*farewell_message_ptr);
     for(auto participant : m_participants)
     {
-      participant->deliver(farewell_message_ptr);
+      participant->deliver(farewell_frame_ptr);
     }
   }
 
@@ -88,6 +105,7 @@ public:
 
   void deliver(message_ptr message)
   {
+    message = make_text_frame(*message);
     m_recent_messages.push_back(message);
     while(m_recent_messages.size() > 10)
     {
@@ -116,7 +134,7 @@ public:
 
   void deliver(message_ptr message) override
   {
-    m_write_msgs.push_back(message);
+    m_socket.enqueue(std::move(message));
     m_event.set();
   }
 
@@ -151,21 +169,14 @@ private:
     {
       while(!token.stop_requested())
       {
-        if(m_write_msgs.empty())
+        if(m_socket.send_queue_empty())
         {
           co_await m_event;
         }
         else
         {
           [[maybe_unused]]
-          const auto& message = *m_write_msgs.front();
-          auto header = websocket_frame_header
-          {
-            websocket_flags::WS_FINAL_FRAME 
-          | websocket_flags::WS_OP_TEXT,
-            message.size()};
-          auto sent_bytes = co_await m_socket.send(header.span(), message);
-          m_write_msgs.pop_front();
+          auto sent_bytes = co_await m_socket.flush();
         }
       }
     }catch(...)
@@ -221,7 +232,6 @@ private:
   socket_t m_socket;
   chat_room& m_room;
   string m_message_head;
-  deque<message_ptr> m_write_msgs;
   single_consumer_async_auto_reset_event m_event;
   stop_source m_stop_source;
 };
@@ -39,6 +39,14 @@ public:
     }
   }
 
+  // a zero-copy send posts a second cqe (IORING_CQE_F_NOTIF) once the kernel
+  // no longer references the user buffer. It must not overwrite the result
+  // of the send itself, so it is only counted here.
+  void add_notification() noexcept
+  {
+    ++m_notifications;
+  }
+
   void execute(async_operation_base* op) noexcept
   {
     m_callback(op);
@@ -58,6 +66,11 @@ public:
     return m_flags;
   }
 
+  auto get_notifications() const noexcept
+  {
+    return m_notifications;
+  }
+
   static void on_operation_completed(async_operation_base *base) noexcept
   {
     base->m_awaiting_coroutine.resume();
@@ -108,6 +121,7 @@ protected:
 private:
   int m_res = 0;
   int m_flags = 0;
+  unsigned int m_notifications = 0;
   std::error_code* mp_error;
 
   io_service* mp_service = nullptr;
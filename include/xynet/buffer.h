@@ -8,7 +8,9 @@
 #include <span>
 #include <vector>
 #include <climits>
+#include <algorithm>
 #include <array>
+#include <memory>
 #include <ranges>
 
 #include <sys/uio.h>
@@ -22,8 +24,7 @@ namespace detail
 template<std::size_t Extent>
 struct buffer_sequence_storage
 {
-  using iterator = typename std::array<::iovec, Extent>::iterator;
-  using size_t   = typename std::array<::iovec, Extent>::size_type;
+  using size_t = typename std::array<::iovec, Extent>::size_type;
   template<typename... Spans>
   constexpr explicit buffer_sequence_storage(Spans&&... spans)
     :m_val{::iovec{
@@ -32,6 +33,9 @@ struct buffer_sequence_storage
   }...}
   {}
 
+  ::iovec* data() noexcept { return m_val.data(); }
+  constexpr size_t size() const noexcept { return Extent; }
+
   std::array<::iovec, Extent> m_val;
 };
 
@@ -39,18 +43,56 @@ template<std::size_t... sizes>
 buffer_sequence_storage(std::span<std::byte, sizes>... spans)
 -> buffer_sequence_storage<sizeof...(sizes)>;
 
+/// the iovecs of a range of buffers. Up to inline_capacity of them are stored in place, in
+/// the awaiter of the operation, and only a longer range allocates.
 template<>
 struct buffer_sequence_storage<std::dynamic_extent>
 {
-  using iterator = typename std::vector<::iovec>::iterator;
-  using size_t   = typename std::vector<::iovec>::size_type;
+  inline static constexpr std::size_t inline_capacity = 8;
+
+  using size_t = std::size_t;
   template<typename BufferRangeView>
   requires std::ranges::view<BufferRangeView>
   explicit buffer_sequence_storage(BufferRangeView view)
-    :m_val{std::ranges::begin(view), std::ranges::end(view)}
-  {}
+  {
+    if constexpr(std::ranges::sized_range<BufferRangeView>)
+    {
+      reserve(std::ranges::size(view));
+    }
+    for(auto&& iov : view)
+    {
+      push_back(iov);
+    }
+  }
+
+  ::iovec* data() noexcept { return mp_heap ? mp_heap.get() : m_inline.data(); }
+  size_t size() const noexcept { return m_size; }
+
+private:
+  void reserve(size_t capacity)
+  {
+    if(capacity > m_capacity)
+    {
+      auto heap = std::make_unique_for_overwrite<::iovec[]>(capacity);
+      std::copy_n(data(), m_size, heap.get());
+      mp_heap    = std::move(heap);
+      m_capacity = capacity;
+    }
+  }
+
+  void push_back(const ::iovec& iov)
+  {
+    if(m_size == m_capacity)
+    {
+      reserve(2 * m_capacity);
+    }
+    data()[m_size++] = iov;
+  }
 
-  std::vector<::iovec> m_val;
+  std::array<::iovec, inline_capacity> m_inline;
+  std::unique_ptr<::iovec[]> mp_heap;
+  size_t m_size = 0;
+  size_t m_capacity = inline_capacity;
 };
 
 template <std::size_t Extent>
@@ -63,47 +105,38 @@ public:
   template<typename... Args>
   buffer_sequence_base(Args&&... args)
     :m_sequence{std::forward<Args>(args)...}
-    ,m_iterator{std::ranges::begin(m_sequence.m_val)}
   {}
 
   auto get_iov_span() -> std::pair<::iovec*, iov_len_t> const
   {
-    return m_iterator == std::ranges::end(m_sequence.m_val)
-           ? std::make_pair(nullptr, 0)
-           : std::make_pair(static_cast<::iovec*>(std::addressof(*m_iterator)),
-                            static_cast<iov_len_t>(
-                              std::distance
-                                (
-                                  m_iterator,
-                                  std::ranges::end(m_sequence.m_val)
-                                )));
+    return std::make_pair(get_iov_ptr(), get_iov_cnt());
   };
 
   auto get_iov_ptr() -> ::iovec*
   {
-    return m_iterator == std::ranges::end(m_sequence.m_val) 
-    ? nullptr : static_cast<::iovec*>(std::addressof(*m_iterator));
+    return m_first == m_sequence.size() ? nullptr : m_sequence.data() + m_first;
   }
 
   auto get_iov_cnt() -> iov_len_t
   {
-    return m_iterator == std::ranges::end(m_sequence.m_val) 
-    ? 0 : static_cast<iov_len_t>(std::distance(m_iterator, std::ranges::end(m_sequence.m_val)));
+    return static_cast<iov_len_t>(m_sequence.size() - m_first);
   }
 
+  // every iovec is skipped once, a commit is O(1) amortized.
   auto commit(iov_len_t len) -> void
   {
-    while(len > 0 && m_iterator != std::ranges::end(m_sequence.m_val))
+    auto* iov = m_sequence.data();
+    while(len > 0 && m_first != m_sequence.size())
     {
-      if(len >= m_iterator->iov_len)
+      if(len >= iov[m_first].iov_len)
       {
-        len -= m_iterator->iov_len;
-        ++m_iterator;
+        len -= iov[m_first].iov_len;
+        ++m_first;
       }
       else
       {
-        m_iterator->iov_base = static_cast<char *>(m_iterator->iov_base) + len;
-        m_iterator->iov_len  -= len;
+        iov[m_first].iov_base = static_cast<char *>(iov[m_first].iov_base) + len;
+        iov[m_first].iov_len  -= len;
         len = 0;
       }
     }
@@ -111,7 +144,9 @@ public:
 
 private:
   buffer_sequence_storage<Extent> m_sequence;
-  typename buffer_sequence_storage<Extent>::iterator m_iterator;
+  // the first iovec not transferred in full. An index rather than a pointer, so that the
+  // sequence can be moved along with its awaiter.
+  std::size_t m_first = 0;
 };
 
 } // namespace detail
@@ -0,0 +1,303 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_BUFFER_POOL_H
+#define XYNET_BUFFER_POOL_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+
+#include "xynet/object_slab.h"
+
+namespace xynet
+{
+
+class buffer_pool;
+
+namespace detail
+{
+
+/// the header of a block, followed by the bytes of the buffer in the same allocation.
+struct alignas(cache_line_size) pooled_block
+{
+  std::atomic<std::uint32_t> ma_refs{1};
+  /// the index of the size class, or oversized for a block that is not pooled.
+  std::uint32_t m_size_class;
+  std::size_t m_capacity;
+  buffer_pool* mp_pool;
+  pooled_block* mp_next = nullptr;
+
+  static constexpr std::uint32_t oversized = UINT32_MAX;
+
+  std::byte* data() noexcept
+  {
+    return reinterpret_cast<std::byte*>(this + 1);
+  }
+};
+
+}
+
+/// \brief a reference-counted handle to a buffer of a buffer_pool. Copies share the buffer,
+///        which goes back to the pool when the last one is released, on any thread.
+///        A contiguous range of std::byte, so it can be passed to buffer_sequence and the
+///        send/recv operations like a std::vector<std::byte>.
+class pooled_buffer
+{
+public:
+  pooled_buffer() noexcept = default;
+
+  pooled_buffer(const pooled_buffer& other) noexcept
+  :mp_block{other.mp_block}
+  ,m_size{other.m_size}
+  {
+    if(mp_block)
+    {
+      mp_block->ma_refs.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  pooled_buffer(pooled_buffer&& other) noexcept
+  :mp_block{std::exchange(other.mp_block, nullptr)}
+  ,m_size{std::exchange(other.m_size, 0)}
+  {}
+
+  pooled_buffer& operator=(pooled_buffer other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~pooled_buffer()
+  {
+    reset();
+  }
+
+  void swap(pooled_buffer& other) noexcept
+  {
+    std::swap(mp_block, other.mp_block);
+    std::swap(m_size, other.m_size);
+  }
+
+  /// \brief release the buffer.
+  void reset() noexcept;
+
+  [[nodiscard]] std::byte* data() const noexcept { return mp_block ? mp_block->data() : nullptr; }
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] std::size_t capacity() const noexcept { return mp_block ? mp_block->m_capacity : 0; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  explicit operator bool() const noexcept { return mp_block != nullptr; }
+
+  [[nodiscard]] std::byte* begin() const noexcept { return data(); }
+  [[nodiscard]] std::byte* end() const noexcept { return data() + m_size; }
+
+  /// \brief change the size within the capacity, e.g. to the bytes received into it.
+  void resize(std::size_t size) noexcept
+  {
+    assert(size <= capacity());
+    m_size = size;
+  }
+
+  /// \brief whether this is the only handle of the buffer, i.e. it may be written to
+  ///        without affecting the other handles.
+  [[nodiscard]]
+  bool unique() const noexcept
+  {
+    return mp_block && mp_block->ma_refs.load(std::memory_order_acquire) == 1;
+  }
+
+private:
+  friend buffer_pool;
+
+  pooled_buffer(detail::pooled_block* block, std::size_t size) noexcept
+  :mp_block{block}
+  ,m_size{size}
+  {}
+
+  detail::pooled_block* mp_block = nullptr;
+  std::size_t m_size = 0;
+};
+
+/// \brief buffers in power-of-two size classes from min_block_size to max_block_size, cached
+///        on a free list per class, so the buffer of a connection or a message does not cost a
+///        call into the allocator once the pool is warm. Larger buffers are allocated and
+///        freed every time.
+///
+///        A buffer released on the thread of the pool goes straight back to its free list. One
+///        released on another thread, e.g. after the connection was handed to another
+///        io_service, is pushed onto a lock-free list that the pool takes back on its next
+///        allocate().
+/// \note  allocate() is called on the thread that created the pool only, e.g. through
+///        buffer_pool::local(). The pool must outlive its buffers.
+class buffer_pool
+{
+  using block = detail::pooled_block;
+
+public:
+  static constexpr std::size_t min_block_size = 256;
+  static constexpr std::size_t max_block_size = 64 * 1024;
+  static constexpr std::size_t size_classes =
+    std::countr_zero(max_block_size) - std::countr_zero(min_block_size) + 1;
+
+  /// \param max_cached  the number of free buffers kept per size class, the rest are freed.
+  explicit buffer_pool(std::size_t max_cached = 256) noexcept
+  :m_max_cached{max_cached}
+  ,m_owner{std::this_thread::get_id()}
+  {}
+
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
+
+  ~buffer_pool()
+  {
+    reclaim_remote();
+    for(auto& list : m_free)
+    {
+      while(list.mp_head != nullptr)
+      {
+        destroy(std::exchange(list.mp_head, list.mp_head->mp_next));
+      }
+    }
+  }
+
+  /// \brief the pool of the calling thread.
+  static buffer_pool& local() noexcept
+  {
+    thread_local auto pool = buffer_pool{};
+    return pool;
+  }
+
+  /// \brief a buffer of size bytes, with a capacity of size rounded up to its size class.
+  /// \throw std::bad_alloc
+  [[nodiscard]]
+  pooled_buffer allocate(std::size_t size)
+  {
+    if(size > max_block_size)[[unlikely]]
+    {
+      return pooled_buffer{create(block::oversized, size), size};
+    }
+
+    auto size_class = size_class_of(size);
+    auto& list = m_free[size_class];
+    if(list.mp_head == nullptr && ma_remote.load(std::memory_order_relaxed) != nullptr)
+    {
+      reclaim_remote();
+    }
+    if(auto* b = list.mp_head; b != nullptr)
+    {
+      list.mp_head = b->mp_next;
+      --list.m_size;
+      b->ma_refs.store(1, std::memory_order_relaxed);
+      return pooled_buffer{b, size};
+    }
+    return pooled_buffer{create(size_class, min_block_size << size_class), size};
+  }
+
+  /// \brief the number of free buffers cached in the size class of size.
+  [[nodiscard]]
+  std::size_t cached(std::size_t size) const noexcept
+  {
+    return m_free[size_class_of(size)].m_size;
+  }
+
+private:
+  friend pooled_buffer;
+
+  struct free_list
+  {
+    block* mp_head = nullptr;
+    std::size_t m_size = 0;
+  };
+
+  static std::size_t size_class_of(std::size_t size) noexcept
+  {
+    return std::bit_width(std::max(size, min_block_size) - 1) - std::countr_zero(min_block_size);
+  }
+
+  block* create(std::uint32_t size_class, std::size_t capacity)
+  {
+    auto* memory = ::operator new(sizeof(block) + capacity, std::align_val_t{alignof(block)});
+    auto* b = ::new (memory) block{};
+    b->m_size_class = size_class;
+    b->m_capacity   = capacity;
+    b->mp_pool      = this;
+    return b;
+  }
+
+  static void destroy(block* b) noexcept
+  {
+    b->~block();
+    ::operator delete(static_cast<void*>(b), std::align_val_t{alignof(block)});
+  }
+
+  void release(block* b) noexcept
+  {
+    if(b->m_size_class == block::oversized)
+    {
+      destroy(b);
+    }
+    else if(std::this_thread::get_id() != m_owner)
+    {
+      b->mp_next = ma_remote.load(std::memory_order_relaxed);
+      while(!ma_remote.compare_exchange_weak(b->mp_next, b,
+                                             std::memory_order_release, std::memory_order_relaxed))
+      {}
+    }
+    else
+    {
+      push_free(b);
+    }
+  }
+
+  void push_free(block* b) noexcept
+  {
+    auto& list = m_free[b->m_size_class];
+    if(list.m_size >= m_max_cached)
+    {
+      destroy(b);
+      return;
+    }
+    b->mp_next = list.mp_head;
+    list.mp_head = b;
+    ++list.m_size;
+  }
+
+  void reclaim_remote() noexcept
+  {
+    auto* b = ma_remote.exchange(nullptr, std::memory_order_acquire);
+    while(b != nullptr)
+    {
+      push_free(std::exchange(b, b->mp_next));
+    }
+  }
+
+  std::array<free_list, size_classes> m_free{};
+  std::size_t m_max_cached;
+  std::thread::id m_owner;
+  /// buffers released by other threads.
+  alignas(cache_line_size) std::atomic<block*> ma_remote{nullptr};
+};
+
+inline void pooled_buffer::reset() noexcept
+{
+  if(auto* b = std::exchange(mp_block, nullptr); b != nullptr)
+  {
+    m_size = 0;
+    if(b->ma_refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+      b->mp_pool->release(b);
+    }
+  }
+}
+
+}
+
+#endif //XYNET_BUFFER_POOL_H
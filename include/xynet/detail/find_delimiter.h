@@ -0,0 +1,111 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_DETAIL_FIND_DELIMITER_H
+#define XYNET_DETAIL_FIND_DELIMITER_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace xynet::detail
+{
+
+inline const char* find_delimiter_scalar(const char* first, const char* last,
+                                         std::string_view delimiter) noexcept
+{
+  auto pos = std::string_view{first, static_cast<std::size_t>(last - first)}.find(delimiter);
+  return pos == std::string_view::npos ? last : first + pos;
+}
+
+#if defined(__x86_64__)
+
+// A block of candidates at a time: the positions where both the first and the last byte of
+// the delimiter match, the bytes in between are compared for those only.
+
+__attribute__((target("avx2")))
+inline const char* find_delimiter_avx2(const char* first, const char* last,
+                                       std::string_view delimiter) noexcept
+{
+  const auto n    = delimiter.size();
+  const auto head = _mm256_set1_epi8(delimiter.front());
+  const auto tail = _mm256_set1_epi8(delimiter.back());
+  auto p = first;
+  for(; static_cast<std::size_t>(last - p) >= n - 1 + 32; p += 32)
+  {
+    auto b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    auto b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n - 1));
+    auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+      _mm256_and_si256(_mm256_cmpeq_epi8(b0, head), _mm256_cmpeq_epi8(b1, tail))));
+    for(; mask != 0; mask &= mask - 1)
+    {
+      auto i = std::countr_zero(mask);
+      if(n <= 2 || std::memcmp(p + i + 1, delimiter.data() + 1, n - 2) == 0)
+      {
+        return p + i;
+      }
+    }
+  }
+  return find_delimiter_scalar(p, last, delimiter);
+}
+
+inline const char* find_delimiter_sse2(const char* first, const char* last,
+                                       std::string_view delimiter) noexcept
+{
+  const auto n    = delimiter.size();
+  const auto head = _mm_set1_epi8(delimiter.front());
+  const auto tail = _mm_set1_epi8(delimiter.back());
+  auto p = first;
+  for(; static_cast<std::size_t>(last - p) >= n - 1 + 16; p += 16)
+  {
+    auto b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    auto b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n - 1));
+    auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(
+      _mm_and_si128(_mm_cmpeq_epi8(b0, head), _mm_cmpeq_epi8(b1, tail))));
+    for(; mask != 0; mask &= mask - 1)
+    {
+      auto i = std::countr_zero(mask);
+      if(n <= 2 || std::memcmp(p + i + 1, delimiter.data() + 1, n - 2) == 0)
+      {
+        return p + i;
+      }
+    }
+  }
+  return find_delimiter_scalar(p, last, delimiter);
+}
+
+#endif
+
+/// \brief the first occurrence of delimiter in [first, last), or last if there is none.
+///        Vectorized with AVX2 if the cpu has it, SSE2 otherwise on x86-64.
+inline const char* find_delimiter(const char* first, const char* last,
+                                  std::string_view delimiter) noexcept
+{
+  if(delimiter.empty())
+  {
+    return first;
+  }
+  if(static_cast<std::size_t>(last - first) < delimiter.size())
+  {
+    return last;
+  }
+#if defined(__x86_64__)
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  return has_avx2
+    ? find_delimiter_avx2(first, last, delimiter)
+    : find_delimiter_sse2(first, last, delimiter);
+#else
+  return find_delimiter_scalar(first, last, delimiter);
+#endif
+}
+
+}
+
+#endif //XYNET_DETAIL_FIND_DELIMITER_H
@@ -5,28 +5,26 @@
 #ifndef XYNET_FILE_H
 #define XYNET_FILE_H
 
-#include "xynet/socket/impl/policy.h"
 #include "xynet/file_descriptor.h"
 #include "xynet/file/impl/openat.h"
 #include "xynet/file/impl/statx.h"
 #include "xynet/file/impl/preadv.h"
+#include "xynet/file/impl/pwritev.h"
 
 namespace xynet
 {
 
-using file_t = file_descriptor<
-  detail::map
-    <
-    detail::module_list
-      <
-        file_statx,
-        operation_openat,
-        operation_read
-      >
-    , detail::with<exception_policy>::template map_front
-    >::type
+using file_t = file_descriptor
+<
+  detail::module_list
+  <
+    file_statx,
+    operation_openat,
+    operation_read,
+    operation_write
+  >
 >;
 
 }
 
-#endif //XYNET_SOCKET_H
+#endif //XYNET_FILE_H
@@ -6,73 +6,103 @@
 #define XYNET_FILE_OPENAT_H
 
 #include "xynet/detail/async_operation.h"
-#include "xynet/detail/throw_or_return.h"
 #include <fcntl.h>
 #include <filesystem>
 
 namespace xynet
 {
 
-template<detail::FileDescriptorPolicy P, typename F>
-struct operation_openat
+template<typename Policy, typename F>
+class async_openat : public async_operation<Policy, async_openat<Policy, F>>
 {
-  struct async_openat : public async_operation<P, async_openat, false>
-  {
+public:
+  template<typename... Args>
+  async_openat(F& file, std::filesystem::path path, int flags, ::mode_t mode, Args&&... args) noexcept
+  : async_operation<Policy, async_openat<Policy, F>>{std::forward<Args>(args)...}
+  , m_file{file}
+  , m_path{std::move(path)}
+  , m_file_flags{flags}
+  , m_file_mode{mode}
+  {}
 
-    async_openat(F& file, std::filesystem::path path, int flags, mode_t mode) noexcept
-    : async_operation<P, async_openat, false>{}
-    , m_file{file}
-    , m_path{std::move(path)}
-    , m_file_flags{flags}
-    , m_file_mode{mode}
-    {}
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
 
-    auto initial_check() const noexcept
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe *sqe)
     {
-      return true;
-    }
+      ::io_uring_prep_openat(sqe,
+                             AT_FDCWD,
+                             m_path.c_str(),
+                             m_file_flags | O_CLOEXEC,
+                             m_file_mode);
+
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
 
-    auto try_start() noexcept
+  decltype(auto) get_result()
+  noexcept (Policy::error_code_type::value)
+  {
+    if (!async_operation_base::get_error_code())[[likely]]
     {
-      return [this](::io_uring_sqe *sqe)
+      // reopening a file closes the old one, as socket_init does.
+      if(m_file.valid())
       {
-        ::io_uring_prep_openat(sqe,
-                               AT_FDCWD,
-                               m_path.c_str(),
-                               m_file_flags,
-                               m_file_mode);
-
-        sqe->user_data = reinterpret_cast<uintptr_t>(this);
-      };
+        m_file.close__();
+      }
+      m_file.set(async_operation_base::get_res());
     }
-
-    auto get_result()
-    noexcept (detail::FileDescriptorPolicyUseErrorCode<P>)
-    -> detail::file_descriptor_operation_return_type_t<P>
+    else[[unlikely]]
     {
-      if (async_operation_base::no_error_in_result())
+      if constexpr (!Policy::error_code_type::value)
       {
-        m_file.set(async_operation_base::get_res());
+        throw std::system_error{async_operation_base::get_error_code()};
       }
-      return detail::async_throw_or_return<P>(async_operation_base::get_error_code());
     }
+  }
 
-  private:
-    F& m_file;
-    std::filesystem::path m_path;
-    int m_file_flags;
-    mode_t m_file_mode;
-  };
+  friend async_operation<Policy, async_openat<Policy, F>>;
+  F& m_file;
+  std::filesystem::path m_path;
+  int m_file_flags;
+  ::mode_t m_file_mode;
+};
 
+template<typename F, typename... Args>
+async_openat(F& file, std::filesystem::path path, int flags, ::mode_t mode, Args&&... args) noexcept
+-> async_openat<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
 
+template<typename F>
+struct operation_openat
+{
+  /// \brief      Create an awaiter to open the file at path, same as openat(2) with AT_FDCWD.
+  ///             O_CLOEXEC is always added to flags.
+  /// \param      args
+  ///
+  /// 1. Args is void:
+  ///   The awaiter returned by the function will throw exception to report the error.
+  ///
+  /// 2. Args is a Duration, i.e. std::chrono::duration<Rep, Period>.
+  ///   This duration will be treated as the timeout for the operation.
+  ///
+  /// 3. Args is an lvalue reference of a std::error_code
+  ///   The awaiter returned by the function will use std::error_code to report the error.
+  ///
+  /// 4. Args are first a Duration, second an lvalue reference of a std::error_code
+  ///   The operation will have the features described in 2 and 3.
   template<typename... Args>
   [[nodiscard]]
-  decltype(auto) openat(Args&&... args) noexcept 
+  decltype(auto) openat(std::filesystem::path path, int flags, ::mode_t mode, Args&&... args) noexcept
   {
-    return async_openat{*static_cast<F*>(this), std::forward<Args>(args)...};
+    return async_openat{*static_cast<F*>(this), std::move(path), flags, mode, std::forward<Args>(args)...};
   }
 };
 
 }
 
-#endif
+#endif //XYNET_FILE_OPENAT_H
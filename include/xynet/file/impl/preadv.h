@@ -12,74 +12,117 @@
 
 namespace xynet
 {
-template<detail::FileDescriptorPolicy P, typename F>
-struct operation_read
+
+template<typename BufferType, typename BasePolicy>
+struct async_read_policy : public BasePolicy::policy_type
+{
+  using buffer_type = BufferType;
+};
+
+template<typename Policy, typename F>
+class async_read : public async_operation<Policy, async_read<Policy, F>>
 {
-  template<typename BufferSequence>
-  struct async_read : public async_operation<P, async_read<BufferSequence>, false>
+public:
+  template<typename... Args>
+  async_read(F& file, ::off_t offset, Args&&... args) noexcept
+  :async_operation<Policy, async_read<Policy, F>>{}
+  ,m_file{file}
+  ,m_buffers{std::forward<Args>(args)...}
+  ,m_offset{offset}
+  {}
+
+  template<typename... Args>
+  async_read(F& file, ::off_t offset, std::error_code& error, Args&&... args) noexcept
+  :async_operation<Policy, async_read<Policy, F>>{error}
+  ,m_file{file}
+  ,m_buffers{std::forward<Args>(args)...}
+  ,m_offset{offset}
+  {}
+
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept 
   {
-    template<typename... Args>
-    async_read(F& file, off_t offset, Args&&... args) noexcept
-    :async_operation<P, async_read, false>{}
-    ,m_file{file}
-    ,m_buffers{static_cast<Args&&>(args)...}
-    ,m_offset{offset}
-    {}
-
-    auto initial_check() const noexcept
+    return [this](::io_uring_sqe* sqe)
     {
-      return true;
-    }
+      ::io_uring_prep_readv(sqe,
+                            m_file.get(),
+                            m_buffers.get_iov_ptr(),
+                            m_buffers.get_iov_cnt(),
+                            m_offset);
+
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
 
-    [[nodiscard]]
-    auto try_start() noexcept 
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if(auto& error = async_operation_base::get_error_code(); error)[[unlikely]]
     {
-      return [this](::io_uring_sqe* sqe)
+      if constexpr (!Policy::error_code_type::value)
       {
-        ::io_uring_prep_readv(sqe,
-                              m_file.get(),
-                              m_buffers.get_iov_ptr(),
-                              m_buffers.get_iov_cnt(),
-                              m_offset);
-
-        sqe->user_data = reinterpret_cast<uintptr_t>(this);
-      };
+        throw std::system_error{error};
+      }
+      return 0;
     }
+    return static_cast<std::size_t>(async_operation_base::get_res());
+  }
 
-    auto get_result()
-    noexcept (detail::FileDescriptorPolicyUseErrorCode<P>)
-    ->detail::file_descriptor_operation_return_type_t<P, std::size_t>
-    {
-      return async_throw_or_return<P>(async_operation_base::get_error_code()
-      , static_cast<std::size_t>(async_operation_base::get_res()));
-    }
+  friend async_operation<Policy, async_read<Policy, F>>;
+  F& m_file;
+  Policy::buffer_type m_buffers;
+  ::off_t m_offset;
+};
 
-  private:
-    F& m_file;
-    BufferSequence m_buffers;
-    off_t m_offset;
-  };
+template<typename F>
+struct operation_read
+{
+  /// \brief      create an awaiter for calling preadv(2) asynchronously at offset 0. It returns
+  ///             the bytes read, which is 0 at the end of the file.
+  /// \param[out] args buffers that will be filled, same as the buffers of recv_some.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) read_some(Args&&... args) noexcept
+  {
+    return read_some_offset(0, std::forward<Args>(args)...);
+  }
 
+  /// \brief same as read_some(Args&&... args), but use std::error_code to report error.
   template<typename... Args>
   [[nodiscard]]
-  decltype(auto) read_some(Args&&... args)
-  noexcept
+  decltype(auto) read_some(std::error_code& error, Args&&... args) noexcept
   {
-    return async_read<decltype(buffer_sequence{std::forward<Args>(args)...})>
-    {*static_cast<F*>(this), 0, std::forward<Args>(args)...};
+    return read_some_offset(0, error, std::forward<Args>(args)...);
   }
 
+  /// \brief same as read_some(Args&&... args), but read from the given offset of the file.
   template<typename... Args>
   [[nodiscard]]
-  decltype(auto) read_some_offset(off_t offset, Args&&... args)
-  noexcept
+  decltype(auto) read_some_offset(::off_t offset, Args&&... args) noexcept
   {
-    return async_read<decltype(buffer_sequence{std::forward<Args>(args)...})>
-    {*static_cast<F*>(this), offset, std::forward<Args>(args)...};
+    using policy = async_read_policy<decltype(buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<>>;
+    return async_read<policy, F>{*static_cast<F*>(this), offset, std::forward<Args>(args)...};
   }
 
+  /// \brief same as read_some_offset(offset, Args&&... args), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) read_some_offset(::off_t offset, std::error_code& error, Args&&... args) noexcept
+  {
+    using policy = async_read_policy<decltype(buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<std::error_code>>;
+    return async_read<policy, F>{*static_cast<F*>(this), offset, error, std::forward<Args>(args)...};
+  }
 };
 
 }
 
-#endif //XYNET_READ_H
+#endif //XYNET_FILE_PREADV_H
@@ -0,0 +1,171 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_FILE_PWRITEV_H
+#define XYNET_FILE_PWRITEV_H
+
+#include <type_traits>
+#include "xynet/buffer.h"
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/file_descriptor_traits.h"
+
+namespace xynet
+{
+
+template<bool enable_write_some, typename BufferType, typename BasePolicy>
+struct async_write_policy : public BasePolicy::policy_type
+{
+  using write_some_type = std::conditional_t<enable_write_some, std::true_type, std::false_type>;
+  using buffer_type = BufferType;
+};
+
+template<typename Policy, typename F>
+class async_write : public async_operation<Policy, async_write<Policy, F>>
+{
+public:
+  template<typename... Args>
+  async_write(F& file, ::off_t offset, Args&&... args) noexcept
+  :async_operation<Policy, async_write<Policy, F>>{&async_write::on_write_completed}
+  ,m_file{file}
+  ,m_buffers{std::forward<Args>(args)...}
+  ,m_offset{offset}
+  {}
+
+  template<typename... Args>
+  async_write(F& file, ::off_t offset, std::error_code& error, Args&&... args) noexcept
+  :async_operation<Policy, async_write<Policy, F>>{&async_write::on_write_completed, error}
+  ,m_file{file}
+  ,m_buffers{std::forward<Args>(args)...}
+  ,m_offset{offset}
+  {}
+
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  static void on_write_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_write*>(base);
+    if constexpr (Policy::write_some_type::value)
+    {
+      auto ret = base->get_res();
+      op->m_bytes_transferred = ret >= 0 ? ret : 0;
+      async_operation_base::on_operation_completed(base);
+    }
+    else
+    {
+      op->update_result();
+    }
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_writev(sqe,
+                             m_file.get(),
+                             m_buffers.get_iov_ptr(),
+                             m_buffers.get_iov_cnt(),
+                             m_offset + static_cast<::off_t>(m_bytes_transferred));
+
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  void update_result()
+  {
+    if(async_operation_base::get_error_code()
+      || async_operation_base::get_res() == 0)
+    {
+      async_operation_base::get_awaiting_coroutine().resume();
+    }
+    else
+    {
+      m_bytes_transferred += async_operation_base::get_res();
+      m_buffers.commit(async_operation_base::get_res());
+      if(m_buffers.get_iov_ptr() == nullptr)
+      {
+        async_operation_base::get_awaiting_coroutine().resume();
+      }
+      else
+      {
+        async_operation<Policy, async_write<Policy, F>>::submit();
+      }
+    }
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (!Policy::error_code_type::value)
+    {
+      if(auto& error = async_operation_base::get_error_code(); error)[[unlikely]]
+      {
+        throw std::system_error{error};
+      }
+    }
+    return m_bytes_transferred;
+  }
+
+  friend async_operation<Policy, async_write<Policy, F>>;
+  F& m_file;
+  Policy::buffer_type m_buffers;
+  ::off_t m_offset;
+  std::size_t m_bytes_transferred = 0;
+};
+
+template<typename F>
+struct operation_write
+{
+  /// \brief      create an awaiter for calling pwritev(2) asynchronously until all the buffers are
+  ///             written to the file at offset. It returns the bytes written.
+  /// \param[in]  args buffers that will be written, same as the buffers of send.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) write_offset(::off_t offset, Args&&... args) noexcept
+  {
+    using policy = async_write_policy<false, decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<>>;
+    return async_write<policy, F>{*static_cast<F*>(this), offset, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as write_offset(offset, Args&&... args), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) write_offset(::off_t offset, std::error_code& error, Args&&... args) noexcept
+  {
+    using policy = async_write_policy<false, decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<std::error_code>>;
+    return async_write<policy, F>{*static_cast<F*>(this), offset, error, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as write_offset(offset, Args&&... args), but it resumes the coroutine after the
+  ///        first pwritev(2), regardless of whether all the buffers are written or not.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) write_some_offset(::off_t offset, Args&&... args) noexcept
+  {
+    using policy = async_write_policy<true, decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<>>;
+    return async_write<policy, F>{*static_cast<F*>(this), offset, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as write_some_offset(offset, Args&&... args), but use std::error_code to report error.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) write_some_offset(::off_t offset, std::error_code& error, Args&&... args) noexcept
+  {
+    using policy = async_write_policy<true, decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+      async_operation_traits<std::error_code>>;
+    return async_write<policy, F>{*static_cast<F*>(this), offset, error, std::forward<Args>(args)...};
+  }
+};
+
+}
+
+#endif //XYNET_FILE_PWRITEV_H
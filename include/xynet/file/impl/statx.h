@@ -5,87 +5,104 @@
 #ifndef XYNET_FILE_STATX_H
 #define XYNET_FILE_STATX_H
 
+#include <chrono>
+#include <fcntl.h>
+#include <sys/stat.h>
 #include "xynet/detail/async_operation.h"
-#include "xynet/detail/throw_or_return.h"
-#include "sys/stat.h"
 
 namespace xynet
 {
 
-template<detail::FileDescriptorPolicy P, typename F>
-class file_statx
+template<typename Policy, typename F>
+class async_statx : public async_operation<Policy, async_statx<Policy, F>>
 {
+public:
+  template<typename... Args>
+  async_statx(F& file, int flags, unsigned int mask, struct ::statx* statxbuf, Args&&... args) noexcept
+  : async_operation<Policy, async_statx<Policy, F>>{std::forward<Args>(args)...}
+  , m_file{file}
+  , m_statx_flags{flags}
+  , m_statx_mask{mask}
+  , mp_statxbuf{statxbuf}
+  {}
+
 private:
-  struct async_statx : public async_operation<P, async_statx, false>
+  auto initial_check() const noexcept
   {
-    async_statx(F& file, int flags, unsigned int mask, struct ::statx* statxbuf) noexcept
-    : async_operation<P, async_statx, false>{}
-    ,m_file{file}
-    ,m_statx_flags{flags}
-    ,m_statx_mask{mask}
-    ,mp_statxbuf{statxbuf}
-    {}
+    return true;
+  }
 
-    auto initial_check() const noexcept
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe *sqe)
     {
-      return true;
-    }
+      ::io_uring_prep_statx(sqe,
+                            m_file.get(),
+                            &m_statx_pathname,
+                            m_statx_flags | AT_EMPTY_PATH,
+                            m_statx_mask  | STATX_BASIC_STATS,
+                            mp_statxbuf);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
 
-    auto try_start() noexcept
+  decltype(auto) get_result()
+  noexcept (Policy::error_code_type::value)
+  {
+    if constexpr (!Policy::error_code_type::value)
     {
-      return [this](::io_uring_sqe *sqe)
+      if(async_operation_base::get_error_code())[[unlikely]]
       {
-        ::io_uring_prep_statx(sqe,
-                              m_file.get(),
-                              &m_statx_pathname,
-                              m_statx_flags | AT_EMPTY_PATH,
-                              m_statx_mask  | STATX_BASIC_STATS,
-                              mp_statxbuf);
-        sqe->user_data = reinterpret_cast<uintptr_t>(this);
-      };
-    }
-
-    auto get_result()
-    noexcept (detail::FileDescriptorPolicyUseErrorCode<P>)
-    -> detail::file_descriptor_operation_return_type_t<P>
-    {
-      return detail::async_throw_or_return<P>(async_operation_base::get_error_code());
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
     }
+  }
 
-  private:
-    F& m_file;
-    int m_statx_flags;
-    unsigned int m_statx_mask;
-    struct ::statx* mp_statxbuf;
-    char m_statx_pathname = '\0';
+  friend async_operation<Policy, async_statx<Policy, F>>;
+  F& m_file;
+  int m_statx_flags;
+  unsigned int m_statx_mask;
+  struct ::statx* mp_statxbuf;
+  char m_statx_pathname = '\0';
 };
 
-struct ::statx m_statxbuf = {};
+template<typename F, typename... Args>
+async_statx(F& file, int flags, unsigned int mask, struct ::statx* statxbuf, Args&&... args) noexcept
+-> async_statx<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
 
+template<typename F>
+class file_statx
+{
 public:
-
+  /// \brief Create an awaiter to refresh the cached statx(2) of the file, which
+  ///        file_size() and last_modified() read from.
+  /// \param args an optional Duration and/or an lvalue reference of a std::error_code,
+  ///             same as the other operations.
+  template<typename... Args>
   [[nodiscard]]
-  decltype(auto) update_statx() noexcept 
+  decltype(auto) update_statx(Args&&... args) noexcept
   {
-    return async_statx{*static_cast<F*>(this), 0, 0, &m_statxbuf};
+    return async_statx{*static_cast<F*>(this), 0, 0u, &m_statxbuf, std::forward<Args>(args)...};
   }
 
   [[nodiscard]]
-  auto file_size() noexcept
+  auto file_size() const noexcept
   {
     return m_statxbuf.stx_size;
   }
 
   [[nodiscard]]
-  auto last_modified() noexcept
+  auto last_modified() const noexcept
   {
     return std::chrono::system_clock::from_time_t(
       std::time_t{m_statxbuf.stx_mtime.tv_sec}
     );
   }
 
+private:
+  struct ::statx m_statxbuf = {};
 };
 
 }
 
-#endif //XYNET_ACCEPT_H
+#endif //XYNET_FILE_STATX_H
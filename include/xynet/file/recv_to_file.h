@@ -0,0 +1,142 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_FILE_RECV_TO_FILE_H
+#define XYNET_FILE_RECV_TO_FILE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#include "xynet/socket/impl/splice.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+
+namespace xynet
+{
+
+/// the size of each of the two buffers recv_to_file falls back to when the file can not be spliced.
+inline constexpr std::size_t recv_to_file_buffer_size = 128 * 1024;
+
+namespace detail
+{
+
+/// \brief whether file accepts the bytes of a splice(2) from pipe, e.g. not if it is opened with
+///        O_APPEND or its file system does not support splice(2). The pipe is empty, so the
+///        splice fails right away: with EINVAL if the file rejects it, with EAGAIN otherwise.
+inline bool can_splice_to(const splice_pipe& pipe, int file, ::off_t offset) noexcept
+{
+  auto off = static_cast<::loff_t>(offset);
+  return ::splice(pipe.read_fd(), nullptr, file, &off, 1, SPLICE_F_NONBLOCK) >= 0 || errno != EINVAL;
+}
+
+/// \brief receive into one buffer while the other one is being written to the file.
+template<typename Socket, typename File>
+auto recv_to_file_buffered(Socket& socket, File& file, ::off_t offset, std::size_t len, std::error_code& error)
+-> task<std::size_t>
+{
+  auto buffers = std::array{std::vector<std::byte>(recv_to_file_buffer_size),
+                            std::vector<std::byte>(recv_to_file_buffer_size)};
+  auto recv_error  = std::error_code{};
+  auto write_error = std::error_code{};
+
+  auto recv = [&](std::size_t index, std::size_t bytes_received) -> task<std::size_t>
+  {
+    auto size = std::min(len - bytes_received, recv_to_file_buffer_size);
+    if(size == 0)
+    {
+      co_return 0;
+    }
+    co_return co_await socket.recv_some(recv_error, std::span{buffers[index].data(), size});
+  };
+
+  auto write = [&](std::size_t index, std::size_t bytes_written, std::size_t size) -> task<std::size_t>
+  {
+    co_return co_await file.write_offset(offset + static_cast<::off_t>(bytes_written), write_error,
+      std::span{buffers[index].data(), size});
+  };
+
+  auto bytes_written = std::size_t{};
+  auto current = std::size_t{};
+  auto bytes_received = co_await recv(current, 0);
+  auto pending = bytes_received;
+
+  while(!recv_error && pending > 0)
+  {
+    auto [written, next_received]
+      = co_await when_all(write(current, bytes_written, pending), recv(current ^ 1, bytes_received));
+    bytes_written += written;
+    if(write_error)
+    {
+      break;
+    }
+
+    bytes_received += next_received;
+    pending = next_received;
+    current ^= 1;
+  }
+
+  // the peer shutting down the connection ends the transfer early, as it does for splice.
+  if(recv_error == xynet_error_instance::make_error_code(xynet_error::eof))
+  {
+    recv_error.clear();
+  }
+
+  error = write_error ? write_error : recv_error;
+  co_return bytes_written;
+}
+
+}
+
+/// \brief receive up to len bytes from socket and write them to file, starting at offset,
+///        without copying them into the user space: they are spliced from the socket into a
+///        pipe and from the pipe into the file. If the file does not accept splice(2), e.g.
+///        because its file system does not support it or it is opened with O_APPEND,
+///        two recv_to_file_buffer_size buffers are used instead: the next chunk is received
+///        while the current one is being written.
+/// \param[out] error will be reset if there is an error. Otherwise, it will be cleared.
+/// \return the number of bytes written to the file, which is less than len if the peer
+///         shuts down the connection first or an error occurs.
+template<typename Socket, typename File>
+auto recv_to_file(Socket& socket, File& file, ::off_t offset, std::size_t len, std::error_code& error)
+-> task<std::size_t>
+{
+  error.clear();
+  if(len == 0)
+  {
+    co_return 0;
+  }
+
+  // the file is probed before anything is read from the socket: once the bytes are in the
+  // pipe, a file that rejects them could not have them written any other way.
+  auto pipe = detail::splice_pipe{};
+  if(pipe.open() == 0 && !detail::can_splice_to(pipe, file.get(), offset))
+  {
+    co_return co_await detail::recv_to_file_buffered(socket, file, offset, len, error);
+  }
+
+  co_return co_await async_splice
+    {socket, -1, pipe, file, static_cast<std::int64_t>(offset), len, error};
+}
+
+/// \brief same as recv_to_file(socket, file, offset, len, error), but report the error by exception.
+template<typename Socket, typename File>
+auto recv_to_file(Socket& socket, File& file, ::off_t offset, std::size_t len)
+-> task<std::size_t>
+{
+  auto error = std::error_code{};
+  auto bytes_written = co_await recv_to_file(socket, file, offset, len, error);
+  if(error)
+  {
+    throw std::system_error{error};
+  }
+  co_return bytes_written;
+}
+
+}
+
+#endif //XYNET_FILE_RECV_TO_FILE_H
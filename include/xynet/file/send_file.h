@@ -0,0 +1,126 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_FILE_SEND_FILE_H
+#define XYNET_FILE_SEND_FILE_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#include "xynet/socket/impl/splice.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+
+namespace xynet
+{
+
+/// the size of each of the two buffers send_file falls back to when the file can not be spliced.
+inline constexpr std::size_t send_file_buffer_size = 128 * 1024;
+
+namespace detail
+{
+
+/// \brief read the file into one buffer while the other one is being sent.
+template<typename File, typename Socket>
+auto send_file_buffered(File& file, Socket& socket, ::off_t offset, std::size_t len, std::error_code& error)
+-> task<std::size_t>
+{
+  auto buffers = std::array{std::vector<std::byte>(send_file_buffer_size),
+                            std::vector<std::byte>(send_file_buffer_size)};
+  auto read_error = std::error_code{};
+  auto send_error = std::error_code{};
+
+  auto read = [&](std::size_t index, std::size_t bytes_read) -> task<std::size_t>
+  {
+    auto size = std::min(len - bytes_read, send_file_buffer_size);
+    if(size == 0)
+    {
+      co_return 0;
+    }
+    co_return co_await file.read_some_offset(offset + static_cast<::off_t>(bytes_read), read_error,
+      std::span{buffers[index].data(), size});
+  };
+
+  auto send = [&](std::size_t index, std::size_t size) -> task<std::size_t>
+  {
+    co_return co_await socket.send(send_error, std::span{buffers[index].data(), size});
+  };
+
+  auto bytes_sent = std::size_t{};
+  auto current = std::size_t{};
+  auto bytes_read = co_await read(current, 0);
+  auto pending = bytes_read;
+
+  while(!read_error && pending > 0)
+  {
+    auto [sent, next_read] = co_await when_all(send(current, pending), read(current ^ 1, bytes_read));
+    bytes_sent += sent;
+    if(send_error)
+    {
+      break;
+    }
+
+    bytes_read += next_read;
+    pending = next_read;
+    current ^= 1;
+  }
+
+  error = send_error ? send_error : read_error;
+  co_return bytes_sent;
+}
+
+}
+
+/// \brief send len bytes of file, starting at offset, to socket without reading the whole
+///        file into the memory. The bytes are spliced through a pipe, so they never enter
+///        the user space. If the file system does not support splice(2), the file is sent
+///        with two send_file_buffer_size buffers instead: the next chunk is read while the
+///        current one is being sent.
+/// \param[out] error will be reset if there is an error. Otherwise, it will be cleared.
+/// \return the number of bytes sent, which is less than len if the file ends before
+///         offset + len or an error occurs.
+template<typename File, typename Socket>
+auto send_file(File& file, Socket& socket, ::off_t offset, std::size_t len, std::error_code& error)
+-> task<std::size_t>
+{
+  error.clear();
+  if(len == 0)
+  {
+    co_return 0;
+  }
+
+  auto pipe = detail::splice_pipe{};
+  auto bytes_sent = co_await async_splice
+    {file, static_cast<std::int64_t>(offset), pipe, socket, -1, len, error};
+
+  if(error == std::errc::invalid_argument && bytes_sent == 0 && pipe.buffered() == 0)
+  {
+    error.clear();
+    bytes_sent = co_await detail::send_file_buffered(file, socket, offset, len, error);
+  }
+
+  co_return bytes_sent;
+}
+
+/// \brief same as send_file(file, socket, offset, len, error), but report the error by exception.
+template<typename File, typename Socket>
+auto send_file(File& file, Socket& socket, ::off_t offset, std::size_t len)
+-> task<std::size_t>
+{
+  auto error = std::error_code{};
+  auto bytes_sent = co_await send_file(file, socket, offset, len, error);
+  if(error)
+  {
+    throw std::system_error{error};
+  }
+  co_return bytes_sent;
+}
+
+}
+
+#endif //XYNET_FILE_SEND_FILE_H
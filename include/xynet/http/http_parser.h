@@ -62,6 +62,9 @@ public:
 private:
   int parse(const char* buf, size_t len)
   {
+    // phr_parse_request() takes the room for headers in and returns the number parsed,
+    // so a parse of a request that was incomplete would find no room left.
+    m_headers_num = m_headers.size();
     int ret = phr_parse_request(buf, len,
       &mp_method, &m_method_len,
       &mp_path, &m_path_len,
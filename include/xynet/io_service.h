@@ -6,6 +6,8 @@
 #define XYNET_IO_SERVICE_H
 
 #include <list>
+#include <optional>
+#include <vector>
 #include <mutex>
 #include <liburing.h>
 #include <chrono>
@@ -56,6 +58,18 @@ public:
       // LOG(FATAL) << "io_service::io_service(), io_uring_queue_init() failed, return: " << ret;
     }
 
+    // register a sparse table of direct descriptors. An older kernel does without them.
+
+    if(int ret = ::io_uring_register_files_sparse(&m_ring, direct_descriptor_table_size);
+    ret == 0)
+    {
+      m_free_direct_descriptors.reserve(direct_descriptor_table_size);
+      for(auto slot = direct_descriptor_table_size; slot > 0; --slot)
+      {
+        m_free_direct_descriptors.push_back(slot - 1);
+      }
+    }
+
     // initialize the eventfd
 
     if(int ret = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
@@ -104,11 +118,22 @@ public:
         // // LOG(INFO) << "io_service::run_() has submitted the eventfd poll sqe";
       }
 
-      ::io_uring_submit_and_wait(&m_ring, 1);
+      // the operations scheduled locally by the last batch must not wait for a completion.
+      if(m_local_queue.empty())
+      {
+        ::io_uring_submit_and_wait(&m_ring, 1);
+      }
+      else
+      {
+        ::io_uring_submit(&m_ring);
+      }
 
+      auto reaped = std::chrono::steady_clock::now();
+      m_loop_time = reaped;
       get_completion_queue_operation_bases();
       get_remote_queue_operation_bases();
       execute_pending_local();
+      update_loop_lag(std::chrono::steady_clock::now() - reaped);
     }
 
     return;
@@ -293,7 +318,14 @@ public:
       auto& cqe_io_state = *reinterpret_cast<operation_base_ptr>(
           static_cast<uintptr_t>(cqe->user_data)
           );
-      cqe_io_state.set_value(cqe->res, cqe->flags);
+      if(cqe->flags & IORING_CQE_F_NOTIF)[[unlikely]]
+      {
+        cqe_io_state.add_notification();
+      }
+      else
+      {
+        cqe_io_state.set_value(cqe->res, cqe->flags);
+      }
       cq_operation_bases.push_back(&cqe_io_state);
     }
     // LOG(INFO) << "io_service::get_completion_queue_operation_bases() has processed " << cqe_count << "cqes.";
@@ -337,10 +369,66 @@ public:
     return thread_io_service;
   }
 
+  /// \brief the moving average of the delay between reaping a batch of completions and
+  ///        resuming the last coroutine of the batch. It grows when the coroutines do more
+  ///        work per completion than the loop can keep up with.
+  [[nodiscard]]
+  std::chrono::nanoseconds loop_lag() const noexcept
+  {
+    // written by the io_service thread only, and may be read by any thread.
+    return std::chrono::nanoseconds{ma_loop_lag.load(std::memory_order_relaxed)};
+  }
+
+  /// \brief take a free slot of the direct descriptor table, for an operation that creates a
+  ///        file straight into the table(e.g. IORING_OP_SOCKET with a file_index). The slot must
+  ///        be given back once the file in it is closed.
+  /// \return std::nullopt if every slot is taken or the kernel does not support the table.
+  [[nodiscard]]
+  std::optional<unsigned> allocate_direct_descriptor() noexcept
+  {
+    if(m_free_direct_descriptors.empty())
+    {
+      return std::nullopt;
+    }
+    auto slot = m_free_direct_descriptors.back();
+    m_free_direct_descriptors.pop_back();
+    return slot;
+  }
+
+  void release_direct_descriptor(unsigned slot) noexcept
+  {
+    m_free_direct_descriptors.push_back(slot);
+  }
+
+  /// \brief the time the current batch of completions was reaped. A timestamp for the
+  ///        coroutines resumed by the batch that does not cost a read of the clock.
+  [[nodiscard]]
+  std::chrono::steady_clock::time_point loop_time() const noexcept
+  {
+    return m_loop_time;
+  }
+
 private:
   ::io_uring m_ring;
   operation_base_list m_local_queue;
 
+  /* loop lag */
+
+  std::atomic<std::chrono::nanoseconds::rep> ma_loop_lag{};
+  std::chrono::steady_clock::time_point m_loop_time = std::chrono::steady_clock::now();
+
+  /* direct descriptors */
+
+  constexpr static unsigned direct_descriptor_table_size = 1024;
+  std::vector<unsigned> m_free_direct_descriptors;
+
+  void update_loop_lag(std::chrono::nanoseconds lag) noexcept
+  {
+    // exponentially weighted, 1/8 of the newest sample.
+    auto average = loop_lag();
+    ma_loop_lag.store((average + (lag - average) / 8).count(), std::memory_order_relaxed);
+  }
+
   /* stop */
 
   std::atomic_bool ma_is_stop_requested;
@@ -0,0 +1,260 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_IOBUF_H
+#define XYNET_IOBUF_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <ranges>
+#include <span>
+#include <utility>
+
+#include "xynet/buffer_pool.h"
+
+namespace xynet
+{
+
+/// \brief a read buffer made of a chain of pooled buffers. Unlike stream_buffer, the unread
+///        data is never moved: prepare() writes after the last segment or into a new one,
+///        consume() drops the segments that have been read, and append(), split() and
+///        trim_back() only move or share the handles of the segments.
+///
+///        An iobuf is a range of its segments, each a contiguous range of const std::byte, so
+///        its unread data can be sent as it is by send(iobuf), through const_buffer_sequence.
+/// \note  The segments are allocated from buffer_pool::local() of the thread calling
+///        prepare(). A segment shared by two iobufs, e.g. after split(), is not written to
+///        again.
+class iobuf
+{
+public:
+  /// \brief the unread bytes of one buffer of the chain.
+  class segment
+  {
+  public:
+    [[nodiscard]] const std::byte* data() const noexcept { return m_buffer.data() + m_begin; }
+    [[nodiscard]] std::size_t size() const noexcept { return m_end - m_begin; }
+    [[nodiscard]] const std::byte* begin() const noexcept { return data(); }
+    [[nodiscard]] const std::byte* end() const noexcept { return data() + size(); }
+
+  private:
+    friend iobuf;
+
+    segment(pooled_buffer buffer, std::size_t begin, std::size_t end) noexcept
+    :m_buffer{std::move(buffer)}
+    ,m_begin{begin}
+    ,m_end{end}
+    {}
+
+    // the bytes after m_end may be written to.
+    [[nodiscard]]
+    std::size_t room() const noexcept
+    {
+      return m_buffer.unique() ? m_buffer.capacity() - m_end : 0;
+    }
+
+    pooled_buffer m_buffer;
+    std::size_t m_begin;
+    std::size_t m_end;
+  };
+
+  using iterator = std::deque<segment>::const_iterator;
+
+  inline static constexpr std::size_t default_segment_size = 4096;
+
+  /// \param segment_size  the smallest size of a segment allocated by prepare().
+  explicit iobuf(std::size_t segment_size = default_segment_size) noexcept
+  :m_segment_size{segment_size}
+  {}
+
+  iobuf(iobuf&&) noexcept = default;
+  iobuf& operator=(iobuf&&) noexcept = default;
+
+  // readable size
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] std::size_t segment_count() const noexcept { return m_segments.size(); }
+
+  [[nodiscard]] iterator begin() const noexcept { return m_segments.begin(); }
+  [[nodiscard]] iterator end() const noexcept { return m_segments.end(); }
+
+  /// \brief the unread bytes of the first segment, which are contiguous.
+  [[nodiscard]]
+  std::span<const std::byte> front() const noexcept
+  {
+    return m_segments.empty()
+      ? std::span<const std::byte>{}
+      : std::span<const std::byte>{m_segments.front().data(), m_segments.front().size()};
+  }
+
+  /// \brief n contiguous bytes to be written to and then commit()'ed. They follow the last
+  ///        segment if it has room for them, otherwise they are the start of a new segment of
+  ///        at least segment_size bytes.
+  /// \throw std::bad_alloc
+  [[nodiscard]]
+  std::span<std::byte> prepare(std::size_t n)
+  {
+    if(m_segments.empty() || m_segments.back().room() < n)
+    {
+      m_segments.push_back(segment{buffer_pool::local().allocate(std::max(n, m_segment_size)), 0, 0});
+    }
+    auto& tail = m_segments.back();
+    return std::span<std::byte>{tail.m_buffer.data() + tail.m_end, n};
+  }
+
+  /// \brief make n of the bytes returned by the last prepare() readable.
+  void commit(std::size_t n) noexcept
+  {
+    if(m_segments.empty())
+    {
+      return;
+    }
+    auto& tail = m_segments.back();
+    n = std::min(n, tail.m_buffer.capacity() - tail.m_end);
+    tail.m_end += n;
+    m_size += n;
+  }
+
+  /// \brief drop the first n readable bytes, and the segments that have been read.
+  void consume(std::size_t n) noexcept
+  {
+    n = std::min(n, m_size);
+    m_size -= n;
+    while(n > 0)
+    {
+      auto& head = m_segments.front();
+      if(n < head.size())
+      {
+        head.m_begin += n;
+        return;
+      }
+      n -= head.size();
+      if(m_segments.size() == 1 && head.m_buffer.unique())
+      {
+        // the last segment is kept to be written to again from its start.
+        head.m_begin = head.m_end = 0;
+        return;
+      }
+      m_segments.pop_front();
+    }
+  }
+
+  /// \brief drop the last n readable bytes.
+  void trim_back(std::size_t n) noexcept
+  {
+    n = std::min(n, m_size);
+    m_size -= n;
+    while(n > 0)
+    {
+      auto& tail = m_segments.back();
+      if(n < tail.size())
+      {
+        tail.m_end -= n;
+        return;
+      }
+      n -= tail.size();
+      m_segments.pop_back();
+    }
+  }
+
+  /// \brief append a buffer, e.g. the one a message was received into, with its size as
+  ///        the readable bytes. Nothing is copied.
+  void append(pooled_buffer buffer)
+  {
+    if(auto size = buffer.size(); size != 0)
+    {
+      drop_empty_tail();
+      m_segments.push_back(segment{std::move(buffer), 0, size});
+      m_size += size;
+    }
+  }
+
+  /// \brief append the segments of other, leaving it empty. Nothing is copied.
+  void append(iobuf&& other)
+  {
+    drop_empty_tail();
+    for(auto& s : other.m_segments)
+    {
+      if(s.size() != 0)
+      {
+        m_segments.push_back(std::move(s));
+      }
+    }
+    m_size += std::exchange(other.m_size, 0);
+    other.m_segments.clear();
+  }
+
+  /// \brief split off the first n readable bytes, e.g. a complete message. A segment that
+  ///        holds bytes of both parts is shared by them, nothing is copied.
+  /// \return an iobuf with the first n readable bytes, which are consumed from this one.
+  [[nodiscard]]
+  iobuf split(std::size_t n)
+  {
+    n = std::min(n, m_size);
+    auto head = iobuf{m_segment_size};
+    head.m_size = n;
+    m_size -= n;
+    while(n > 0)
+    {
+      auto& s = m_segments.front();
+      if(n < s.size())
+      {
+        head.m_segments.push_back(segment{s.m_buffer, s.m_begin, s.m_begin + n});
+        s.m_begin += n;
+        break;
+      }
+      n -= s.size();
+      head.m_segments.push_back(std::move(s));
+      m_segments.pop_front();
+    }
+    return head;
+  }
+
+  /// \brief copy the first out.size() readable bytes, or all of them if there are fewer,
+  ///        e.g. a header that spans segments.
+  /// \return the number of bytes copied.
+  std::size_t copy_to(std::span<std::byte> out) const noexcept
+  {
+    auto copied = std::size_t{};
+    for(auto it = m_segments.begin(); it != m_segments.end() && copied < out.size(); ++it)
+    {
+      auto n = std::min(it->size(), out.size() - copied);
+      std::memcpy(out.data() + copied, it->data(), n);
+      copied += n;
+    }
+    return copied;
+  }
+
+  /// \brief drop every segment.
+  void clear() noexcept
+  {
+    m_segments.clear();
+    m_size = 0;
+  }
+
+private:
+  // a segment prepared but not written to is not kept in the middle of the chain.
+  void drop_empty_tail() noexcept
+  {
+    if(!m_segments.empty() && m_segments.back().size() == 0)
+    {
+      m_segments.pop_back();
+    }
+  }
+
+  std::deque<segment> m_segments;
+  std::size_t m_size = 0;
+  std::size_t m_segment_size;
+};
+
+}
+
+// size() is the number of readable bytes, not of the segments of the range.
+template<>
+inline constexpr bool std::ranges::disable_sized_range<xynet::iobuf> = true;
+
+#endif //XYNET_IOBUF_H
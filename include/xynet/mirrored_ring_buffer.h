@@ -0,0 +1,199 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_MIRRORED_RING_BUFFER_H
+#define XYNET_MIRRORED_RING_BUFFER_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace xynet
+{
+
+/// \brief a ring buffer whose memory is mapped twice, back to back, so the readable and the
+///        writable bytes are always contiguous, even when they wrap around its end. A
+///        streaming parser such as http_parser or websocket_frame_header_parser gets all the
+///        unread bytes from data(), and nothing is ever moved, unlike stream_buffer::reserve.
+///
+///        The capacity is fixed and rounded up to the page size. With huge_pages, the buffer
+///        is backed by 2 MiB huge pages if the system has any free, and by regular pages
+///        otherwise.
+/// \note  prepare, commit, consume and data work the same as those of stream_buffer, but a
+///        full ring does not grow: prepare(n) returns fewer than n bytes.
+class mirrored_ring_buffer
+{
+public:
+  inline static constexpr std::size_t huge_page_size = 2 * 1024 * 1024;
+
+  /// \throw std::system_error if the memory can not be mapped.
+  explicit mirrored_ring_buffer(std::size_t capacity, bool huge_pages = false)
+  {
+    // MFD_HUGE_2MB of <linux/memfd.h>, which clashes with the definitions of <sys/mman.h>.
+    constexpr auto memfd_huge_2mb = 21u << 26;
+    if(huge_pages && map(round_up(capacity, huge_page_size), MFD_HUGETLB | memfd_huge_2mb, huge_page_size))
+    {
+      m_huge_pages = true;
+      return;
+    }
+    if(!map(round_up(capacity, static_cast<std::size_t>(::sysconf(_SC_PAGESIZE))), 0, 0))
+    {
+      throw std::system_error{std::error_code{errno, std::system_category()}};
+    }
+  }
+
+  mirrored_ring_buffer(mirrored_ring_buffer&& other) noexcept
+  :mp_base{std::exchange(other.mp_base, nullptr)}
+  ,m_capacity{std::exchange(other.m_capacity, 0)}
+  ,m_read{std::exchange(other.m_read, 0)}
+  ,m_size{std::exchange(other.m_size, 0)}
+  ,m_huge_pages{other.m_huge_pages}
+  {}
+
+  mirrored_ring_buffer& operator=(mirrored_ring_buffer&& other) noexcept
+  {
+    if(this != &other)
+    {
+      unmap();
+      mp_base      = std::exchange(other.mp_base, nullptr);
+      m_capacity   = std::exchange(other.m_capacity, 0);
+      m_read       = std::exchange(other.m_read, 0);
+      m_size       = std::exchange(other.m_size, 0);
+      m_huge_pages = other.m_huge_pages;
+    }
+    return *this;
+  }
+
+  ~mirrored_ring_buffer()
+  {
+    unmap();
+  }
+
+  // readable size
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+  [[nodiscard]] bool huge_pages() const noexcept { return m_huge_pages; }
+
+  [[nodiscard]]
+  auto data() const noexcept
+  {
+    return std::span<const std::byte>{mp_base + m_read, m_size};
+  }
+
+  [[nodiscard]]
+  auto data_string_view() const noexcept
+  {
+    return std::string_view{reinterpret_cast<const char*>(mp_base + m_read), m_size};
+  }
+
+  /// \brief the n bytes after the readable ones, or as many as are free.
+  [[nodiscard]]
+  auto prepare(std::size_t n) noexcept
+  {
+    return std::span<std::byte>{mp_base + m_read + m_size, std::min(n, m_capacity - m_size)};
+  }
+
+  void commit(std::size_t n) noexcept
+  {
+    m_size += std::min(n, m_capacity - m_size);
+  }
+
+  void consume(std::size_t n) noexcept
+  {
+    n = std::min(n, m_size);
+    m_size -= n;
+    m_read += n;
+    // the read position stays in the first mapping, its bytes continue into the second.
+    if(m_read >= m_capacity)
+    {
+      m_read -= m_capacity;
+    }
+  }
+
+private:
+  static std::size_t round_up(std::size_t n, std::size_t unit) noexcept
+  {
+    return (std::max<std::size_t>(n, 1) + unit - 1) / unit * unit;
+  }
+
+  // alignment is that of the huge pages, an mmap of regular pages is aligned already.
+  bool map(std::size_t capacity, unsigned int memfd_flags, std::size_t alignment) noexcept
+  {
+    auto fd = ::memfd_create("xynet_mirrored_ring_buffer", MFD_CLOEXEC | memfd_flags);
+    if(fd == -1)
+    {
+      return false;
+    }
+    if(::ftruncate(fd, static_cast<::off_t>(capacity)) == -1)
+    {
+      auto error = errno;
+      ::close(fd);
+      errno = error;
+      return false;
+    }
+
+    // reserve the address range of both mappings, then map the file over each half.
+    auto* base = ::mmap(nullptr, 2 * capacity + alignment, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    auto ok = base != MAP_FAILED;
+    if(ok && alignment != 0)
+    {
+      auto* reserved = static_cast<std::byte*>(base);
+      auto skip = (alignment - reinterpret_cast<std::uintptr_t>(reserved) % alignment) % alignment;
+      if(skip != 0)
+      {
+        ::munmap(reserved, skip);
+      }
+      ::munmap(reserved + skip + 2 * capacity, alignment - skip);
+      base = reserved + skip;
+    }
+    for(auto half = 0; ok && half < 2; ++half)
+    {
+      auto* address = static_cast<std::byte*>(base) + half * capacity;
+      ok = ::mmap(address, capacity, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == address;
+    }
+    auto error = errno;
+    if(!ok && base != MAP_FAILED)
+    {
+      ::munmap(base, 2 * capacity);
+    }
+    // the mappings keep the memory alive.
+    ::close(fd);
+    errno = error;
+
+    if(ok)
+    {
+      mp_base    = static_cast<std::byte*>(base);
+      m_capacity = capacity;
+    }
+    return ok;
+  }
+
+  void unmap() noexcept
+  {
+    if(mp_base != nullptr)
+    {
+      ::munmap(mp_base, 2 * m_capacity);
+      mp_base = nullptr;
+    }
+  }
+
+  std::byte* mp_base = nullptr;
+  std::size_t m_capacity = 0;
+  // the offset of the readable bytes in the first mapping.
+  std::size_t m_read = 0;
+  std::size_t m_size = 0;
+  bool m_huge_pages = false;
+};
+
+}
+
+#endif //XYNET_MIRRORED_RING_BUFFER_H
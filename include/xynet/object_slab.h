@@ -0,0 +1,131 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_OBJECT_SLAB_H
+#define XYNET_OBJECT_SLAB_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace xynet
+{
+
+inline constexpr std::size_t cache_line_size = 64;
+
+/// \brief a fixed number of records of T allocated in one block, each aligned to a cache line,
+///        for objects created and destroyed at a high rate such as connections with their
+///        sessions. Records are handed out and returned through an intrusive free list, so
+///        neither costs a call into the allocator. Keep the socket, the session state and the
+///        small buffers of a connection in one T to have them in one record.
+/// \note  not thread-safe, use one per io_service. The slab must outlive every object made
+///        from it.
+template<typename T>
+class object_slab
+{
+  union alignas(std::max(alignof(T), cache_line_size)) record
+  {
+    record() noexcept : m_next{nullptr} {}
+    ~record() {}
+
+    record* m_next;
+    alignas(T) std::byte m_storage[sizeof(T)];
+  };
+
+  struct deleter
+  {
+    object_slab* mp_slab = nullptr;
+
+    void operator()(T* object) const noexcept
+    {
+      object->~T();
+      mp_slab->release(reinterpret_cast<record*>(object));
+    }
+  };
+
+public:
+  /// \brief an owning pointer to an object in the slab. Empty if the slab was full.
+  using pointer = std::unique_ptr<T, deleter>;
+
+  /// \brief size of a record, sizeof(T) rounded up to a multiple of the cache line.
+  static constexpr std::size_t record_size = sizeof(record);
+
+  explicit object_slab(std::size_t capacity)
+  :m_records{std::make_unique<record[]>(capacity)}
+  ,m_capacity{capacity}
+  {
+    for(auto i = capacity; i > 0; --i)
+    {
+      m_records[i - 1].m_next = mp_free;
+      mp_free = &m_records[i - 1];
+    }
+  }
+
+  object_slab(const object_slab&) = delete;
+  object_slab& operator=(const object_slab&) = delete;
+
+  /// \brief construct a T in a free record.
+  /// \return an empty pointer if every record is in use, e.g. to shed the connection.
+  template<typename... Args>
+  [[nodiscard]]
+  pointer try_make(Args&&... args)
+  {
+    if(mp_free == nullptr)[[unlikely]]
+    {
+      return pointer{nullptr, deleter{this}};
+    }
+
+    auto* r = mp_free;
+    mp_free = r->m_next;
+    try
+    {
+      auto* object = ::new (static_cast<void*>(r->m_storage)) T(std::forward<Args>(args)...);
+      ++m_size;
+      return pointer{object, deleter{this}};
+    }
+    catch(...)
+    {
+      r->m_next = mp_free;
+      mp_free = r;
+      throw;
+    }
+  }
+
+  /// \brief same as try_make(args...), but throw std::bad_alloc if every record is in use.
+  template<typename... Args>
+  [[nodiscard]]
+  pointer make(Args&&... args)
+  {
+    auto object = try_make(std::forward<Args>(args)...);
+    if(!object)
+    {
+      throw std::bad_alloc{};
+    }
+    return object;
+  }
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+  /// \brief the number of records in use.
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] std::size_t available() const noexcept { return m_capacity - m_size; }
+
+private:
+  void release(record* r) noexcept
+  {
+    r->m_next = mp_free;
+    mp_free = r;
+    --m_size;
+  }
+
+  std::unique_ptr<record[]> m_records;
+  std::size_t m_capacity;
+  std::size_t m_size = 0;
+  record* mp_free = nullptr;
+};
+
+}
+
+#endif //XYNET_OBJECT_SLAB_H
@@ -0,0 +1,197 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SHARED_BUFFER_H
+#define XYNET_SHARED_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <span>
+#include <utility>
+
+namespace xynet
+{
+
+/// how the copies of a shared_buffer may be used.
+enum class buffer_sharing
+{
+  /// by the thread of one io_service only, the count of references is not atomic.
+  local,
+  /// by any thread.
+  concurrent
+};
+
+namespace detail
+{
+
+/// the header of a shared_buffer, followed by its bytes in the same allocation.
+struct shared_block
+{
+  std::size_t m_refs = 1;
+  buffer_sharing m_sharing;
+
+  std::byte* data() noexcept
+  {
+    return reinterpret_cast<std::byte*>(this + 1);
+  }
+
+  void acquire() noexcept
+  {
+    if(m_sharing == buffer_sharing::local)
+    {
+      ++m_refs;
+    }
+    else
+    {
+      std::atomic_ref{m_refs}.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  /// \return whether this was the last reference.
+  bool release() noexcept
+  {
+    if(m_sharing == buffer_sharing::local)
+    {
+      return --m_refs == 0;
+    }
+    return std::atomic_ref{m_refs}.fetch_sub(1, std::memory_order_acq_rel) == 1;
+  }
+};
+
+}
+
+/// \brief an immutable, reference-counted buffer, e.g. an encoded message that is sent to many
+///        sockets. The count of references and the bytes are one allocation, and a copy or a
+///        slice of it only adds a reference, so a message fans out to any number of sockets
+///        without being copied.
+///
+///        A contiguous range of const std::byte, so it can be passed to send() and
+///        const_buffer_sequence, alone or in a range, and enqueued to the send queue.
+/// \note  The bytes are written through writable() before the buffer is copied. A buffer of
+///        buffer_sharing::local, the default, must not be copied or released on another thread.
+class shared_buffer
+{
+public:
+  shared_buffer() noexcept = default;
+
+  /// \brief a buffer of size bytes, to be filled through writable().
+  /// \throw std::bad_alloc
+  explicit shared_buffer(std::size_t size, buffer_sharing sharing = buffer_sharing::local)
+  :mp_block{::new (::operator new(sizeof(detail::shared_block) + size))
+              detail::shared_block{.m_sharing = sharing}}
+  ,m_size{size}
+  {}
+
+  /// \brief a buffer holding a copy of bytes.
+  /// \throw std::bad_alloc
+  explicit shared_buffer(std::span<const std::byte> bytes, buffer_sharing sharing = buffer_sharing::local)
+  :shared_buffer{bytes.size(), sharing}
+  {
+    if(!bytes.empty())
+    {
+      std::memcpy(mp_block->data(), bytes.data(), bytes.size());
+    }
+  }
+
+  shared_buffer(const shared_buffer& other) noexcept
+  :mp_block{other.mp_block}
+  ,m_offset{other.m_offset}
+  ,m_size{other.m_size}
+  {
+    if(mp_block)
+    {
+      mp_block->acquire();
+    }
+  }
+
+  shared_buffer(shared_buffer&& other) noexcept
+  :mp_block{std::exchange(other.mp_block, nullptr)}
+  ,m_offset{std::exchange(other.m_offset, 0)}
+  ,m_size{std::exchange(other.m_size, 0)}
+  {}
+
+  shared_buffer& operator=(shared_buffer other) noexcept
+  {
+    swap(other);
+    return *this;
+  }
+
+  ~shared_buffer()
+  {
+    reset();
+  }
+
+  void swap(shared_buffer& other) noexcept
+  {
+    std::swap(mp_block, other.mp_block);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_size, other.m_size);
+  }
+
+  /// \brief release the buffer, which is freed with its last reference.
+  void reset() noexcept
+  {
+    if(auto* b = std::exchange(mp_block, nullptr); b != nullptr && b->release())
+    {
+      b->~shared_block();
+      ::operator delete(static_cast<void*>(b));
+    }
+    m_offset = 0;
+    m_size   = 0;
+  }
+
+  [[nodiscard]] const std::byte* data() const noexcept { return mp_block ? mp_block->data() + m_offset : nullptr; }
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  explicit operator bool() const noexcept { return mp_block != nullptr; }
+
+  [[nodiscard]] const std::byte* begin() const noexcept { return data(); }
+  [[nodiscard]] const std::byte* end() const noexcept { return data() + m_size; }
+
+  /// \brief the bytes of a buffer that has not been copied yet, to fill it.
+  [[nodiscard]]
+  std::span<std::byte> writable() noexcept
+  {
+    assert(use_count() == 1);
+    return mp_block ? std::span<std::byte>{mp_block->data() + m_offset, m_size} : std::span<std::byte>{};
+  }
+
+  /// \brief a buffer of length bytes from offset, sharing the allocation of this one.
+  [[nodiscard]]
+  shared_buffer slice(std::size_t offset, std::size_t length = SIZE_MAX) const noexcept
+  {
+    offset = std::min(offset, m_size);
+    auto slice = *this;
+    slice.m_offset += offset;
+    slice.m_size    = std::min(length, m_size - offset);
+    return slice;
+  }
+
+  /// \brief the number of buffers sharing the allocation.
+  [[nodiscard]]
+  std::size_t use_count() const noexcept
+  {
+    if(!mp_block)
+    {
+      return 0;
+    }
+    return mp_block->m_sharing == buffer_sharing::local
+      ? mp_block->m_refs
+      : std::atomic_ref{mp_block->m_refs}.load(std::memory_order_acquire);
+  }
+
+private:
+  detail::shared_block* mp_block = nullptr;
+  std::size_t m_offset = 0;
+  std::size_t m_size = 0;
+};
+
+}
+
+#endif //XYNET_SHARED_BUFFER_H
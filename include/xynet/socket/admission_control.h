@@ -0,0 +1,196 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_ADMISSION_CONTROL_H
+#define XYNET_SOCKET_ADMISSION_CONTROL_H
+
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <utility>
+#include <sys/socket.h>
+
+#include "xynet/io_service.h"
+
+namespace xynet
+{
+
+struct admission_options
+{
+  /// the maximum number of connections served at the same time, 0 for no limit.
+  std::size_t max_connections = 0;
+  /// the sustained number of connections admitted per second, 0 for no limit.
+  double accept_rate = 0;
+  /// the number of connections that may be admitted at once above accept_rate.
+  std::size_t accept_burst = 64;
+  /// shed new connections while io_service::loop_lag() is above this, 0 to disable.
+  std::chrono::nanoseconds max_loop_lag{};
+  /// sent to a shed connection before it is closed, e.g. an HTTP 503. If empty, the
+  /// connection is reset, which frees it without going through TIME_WAIT.
+  std::string_view shed_response{};
+};
+
+enum class admission_result
+{
+  admitted,
+  too_many_connections,
+  rate_limited,
+  overloaded,
+};
+
+/// \brief decides in the accept path whether a new connection is served or shed, so that
+///        a connection flood does not slow down the connections that are already served.
+/// \note  not thread-safe, use one per io_service.
+class admission_control
+{
+  using clock = std::chrono::steady_clock;
+
+public:
+  /// \brief held for as long as an admitted connection is served.
+  class ticket
+  {
+  public:
+    ticket() noexcept = default;
+
+    ticket(admission_control* control, admission_result result) noexcept
+    :mp_control{control}
+    ,m_result{result}
+    {}
+
+    ticket(ticket&& other) noexcept
+    :mp_control{std::exchange(other.mp_control, nullptr)}
+    ,m_result{other.m_result}
+    {}
+
+    ticket& operator=(ticket&& other) noexcept
+    {
+      if(this != &other)
+      {
+        reset();
+        mp_control = std::exchange(other.mp_control, nullptr);
+        m_result   = other.m_result;
+      }
+      return *this;
+    }
+
+    ~ticket()
+    {
+      reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return m_result == admission_result::admitted;
+    }
+
+    [[nodiscard]]
+    admission_result result() const noexcept
+    {
+      return m_result;
+    }
+
+    void reset() noexcept
+    {
+      if(auto* control = std::exchange(mp_control, nullptr); control)
+      {
+        --control->m_active;
+      }
+    }
+
+  private:
+    admission_control* mp_control = nullptr;
+    admission_result m_result = admission_result::overloaded;
+  };
+
+  explicit admission_control(io_service& service, admission_options options = {}) noexcept
+  :m_service{service}
+  ,m_options{options}
+  ,m_tokens{static_cast<double>(options.accept_burst)}
+  ,m_last_refill{clock::now()}
+  {}
+
+  admission_control(const admission_control&) = delete;
+  admission_control& operator=(const admission_control&) = delete;
+
+  /// \brief admit a new connection. The returned ticket converts to false if the connection
+  ///        must be shed, and result() tells why.
+  [[nodiscard]]
+  ticket try_admit() noexcept
+  {
+    auto result = check();
+    if(result != admission_result::admitted)
+    {
+      ++m_shed;
+      return ticket{nullptr, result};
+    }
+
+    ++m_active;
+    ++m_admitted;
+    return ticket{this, result};
+  }
+
+  /// \brief send the canned response to a shed connection, without waiting for the socket
+  ///        to become writable, and make the following close(2) free it right away.
+  void shed(int fd) const noexcept
+  {
+    if(!m_options.shed_response.empty())
+    {
+      ::send(fd, m_options.shed_response.data(), m_options.shed_response.size(),
+             MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+    else
+    {
+      auto linger = ::linger{.l_onoff = 1, .l_linger = 0};
+      ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+    }
+  }
+
+  [[nodiscard]] std::size_t active() const noexcept { return m_active; }
+  [[nodiscard]] std::size_t admitted() const noexcept { return m_admitted; }
+  [[nodiscard]] std::size_t shed() const noexcept { return m_shed; }
+  [[nodiscard]] const admission_options& options() const noexcept { return m_options; }
+
+private:
+  admission_result check() noexcept
+  {
+    if(m_options.max_connections != 0 && m_active >= m_options.max_connections)
+    {
+      return admission_result::too_many_connections;
+    }
+
+    if(m_options.max_loop_lag != std::chrono::nanoseconds::zero()
+    && m_service.loop_lag() > m_options.max_loop_lag)
+    {
+      return admission_result::overloaded;
+    }
+
+    if(m_options.accept_rate > 0)
+    {
+      auto now = clock::now();
+      auto elapsed = std::chrono::duration<double>(now - m_last_refill).count();
+      m_last_refill = now;
+      m_tokens = std::min(m_tokens + elapsed * m_options.accept_rate,
+                          static_cast<double>(m_options.accept_burst));
+      if(m_tokens < 1.)
+      {
+        return admission_result::rate_limited;
+      }
+      m_tokens -= 1.;
+    }
+
+    return admission_result::admitted;
+  }
+
+  io_service& m_service;
+  admission_options m_options;
+  double m_tokens;
+  clock::time_point m_last_refill;
+  std::size_t m_active = 0;
+  std::size_t m_admitted = 0;
+  std::size_t m_shed = 0;
+};
+
+}
+
+#endif //XYNET_SOCKET_ADMISSION_CONTROL_H
@@ -0,0 +1,150 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_CONNECTION_DISPATCHER_H
+#define XYNET_SOCKET_CONNECTION_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#include "xynet/io_service.h"
+#include "xynet/object_slab.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/async_scope.h"
+#include "xynet/detail/scope_guard.h"
+
+namespace xynet
+{
+
+/// the loop lags that dispatch_policy::lowest_loop_lag does not tell apart. Lags a few
+/// microseconds apart are noise, so within it the worker with fewer connections wins.
+inline constexpr std::chrono::nanoseconds dispatch_loop_lag_granularity = std::chrono::milliseconds{1};
+
+enum class dispatch_policy
+{
+  /// the worker serving the fewest connections.
+  fewest_connections,
+  /// the worker with the lowest io_service::loop_lag(), in dispatch_loop_lag_granularity
+  /// steps, then the fewest connections.
+  lowest_loop_lag,
+};
+
+/// \brief accept on one io_service and serve on N: hands every accepted connection to the
+///        least loaded of the worker io_services. Unlike SO_REUSEPORT sharding, where the
+///        kernel hashes a connection to a listener without regard to its load, long-lived
+///        connections such as websockets do not pile up on one worker.
+///
+///        The socket is moved to the worker through its remote queue, and the connection
+///        counts against the worker until serve returns.
+/// \note  dispatch() is called by the accepting thread only. The load of the workers may
+///        be read from any thread.
+class connection_dispatcher
+{
+  struct alignas(cache_line_size) worker
+  {
+    io_service* mp_service = nullptr;
+    std::atomic<std::size_t> ma_active{0};
+  };
+
+public:
+  /// \throw std::invalid_argument if services is empty.
+  explicit connection_dispatcher(std::span<io_service* const> services,
+                                 dispatch_policy policy = dispatch_policy::fewest_connections)
+  :m_workers{std::make_unique<worker[]>(services.size())}
+  ,m_size{services.size()}
+  ,m_policy{policy}
+  {
+    if(m_size == 0)
+    {
+      throw std::invalid_argument{"connection_dispatcher: no io_service to dispatch to"};
+    }
+    for(auto i = std::size_t{}; i < m_size; ++i)
+    {
+      m_workers[i].mp_service = services[i];
+    }
+  }
+
+  connection_dispatcher(const connection_dispatcher&) = delete;
+  connection_dispatcher& operator=(const connection_dispatcher&) = delete;
+
+  /// \brief co_await serve(std::move(socket)) on the least loaded worker, spawned in scope.
+  ///        serve must not throw.
+  /// \return the index of the worker the connection was handed to.
+  template<typename Socket, typename Serve>
+  std::size_t dispatch(async_scope& scope, Socket socket, Serve serve)
+  {
+    auto index = pick();
+    auto& w = m_workers[index];
+    w.ma_active.fetch_add(1, std::memory_order_relaxed);
+    scope.spawn(serve_on(w, std::move(socket), std::move(serve)));
+    return index;
+  }
+
+  /// \brief the index of the worker that the next connection will be handed to. Workers that
+  ///        are equally loaded take turns.
+  [[nodiscard]]
+  std::size_t pick() noexcept
+  {
+    auto best = m_next;
+    for(auto n = std::size_t{1}; n < m_size; ++n)
+    {
+      auto i = (m_next + n) % m_size;
+      if(less_loaded(m_workers[i], m_workers[best]))
+      {
+        best = i;
+      }
+    }
+    m_next = (best + 1) % m_size;
+    return best;
+  }
+
+  /// \brief the number of connections being served by the worker at index.
+  [[nodiscard]]
+  std::size_t active_connections(std::size_t index) const noexcept
+  {
+    return m_workers[index].ma_active.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+private:
+  template<typename Socket, typename Serve>
+  static auto serve_on(worker& w, Socket socket, Serve serve) -> task<>
+  {
+    auto _ = scope_guard{[&w]{ w.ma_active.fetch_sub(1, std::memory_order_relaxed); }};
+    // resumes on the thread of the worker.
+    co_await w.mp_service->schedule();
+    co_await serve(std::move(socket));
+  }
+
+  bool less_loaded(const worker& lhs, const worker& rhs) const noexcept
+  {
+    auto lhs_active = lhs.ma_active.load(std::memory_order_relaxed);
+    auto rhs_active = rhs.ma_active.load(std::memory_order_relaxed);
+    if(m_policy == dispatch_policy::lowest_loop_lag)
+    {
+      auto lhs_lag = lhs.mp_service->loop_lag() / dispatch_loop_lag_granularity;
+      auto rhs_lag = rhs.mp_service->loop_lag() / dispatch_loop_lag_granularity;
+      if(lhs_lag != rhs_lag)
+      {
+        return lhs_lag < rhs_lag;
+      }
+    }
+    return lhs_active < rhs_active;
+  }
+
+  std::unique_ptr<worker[]> m_workers;
+  std::size_t m_size;
+  dispatch_policy m_policy;
+  std::size_t m_next = 0;
+};
+
+}
+
+#endif //XYNET_SOCKET_CONNECTION_DISPATCHER_H
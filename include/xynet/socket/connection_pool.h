@@ -0,0 +1,389 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_CONNECTION_POOL_H
+#define XYNET_SOCKET_CONNECTION_POOL_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <deque>
+#include <list>
+#include <map>
+#include <optional>
+#include <stop_token>
+#include <system_error>
+#include <vector>
+#include <sys/socket.h>
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+
+namespace xynet
+{
+
+struct connection_pool_options
+{
+  /// the maximum number of connections, idle or in use, to one backend. acquire()
+  /// waits for a connection to be released once the limit is reached.
+  std::size_t max_connections = 64;
+  /// the maximum number of idle connections kept for one backend.
+  std::size_t max_idle_connections = 16;
+  /// idle connections older than this are closed by reap_idle().
+  std::chrono::milliseconds idle_timeout = std::chrono::seconds{30};
+  /// how often run_reaper() calls reap_idle().
+  std::chrono::milliseconds reap_interval = std::chrono::seconds{1};
+  /// the options applied to every new connection.
+  socket_profile profile = socket_profile::low_latency();
+};
+
+/// \brief a pool of client connections for the io_service of the current thread, keyed by
+///        the address of the backend. Connections are reused in LIFO order, so the ones that
+///        are used often stay warm and the rest time out.
+/// \note  the pool is not thread-safe, it must be used on the thread of its io_service, and it
+///        must outlive every connection acquired from it.
+template<typename Socket = socket_t>
+class connection_pool
+{
+  using clock = std::chrono::steady_clock;
+
+  struct idle_connection
+  {
+    Socket m_socket;
+    clock::time_point m_idle_since;
+  };
+
+  /// an acquire() waiting for a connection. It is resumed through the io_service
+  /// with either a released connection or, if a connection was closed, nothing,
+  /// in which case it may open a new one.
+  struct waiter : public async_operation_base
+  {
+    explicit waiter(io_service* service) noexcept
+    :async_operation_base{service}
+    {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+    {
+      set_awaiting_coroutine(awaiting_coroutine);
+    }
+
+    void await_resume() const noexcept {}
+
+    std::optional<Socket> m_socket;
+  };
+
+  struct backend
+  {
+    std::deque<idle_connection> m_idle;
+    std::list<waiter*> m_waiters;
+    std::size_t m_connections = 0;
+  };
+
+public:
+  /// \brief a connection checked out of the pool. It is returned to the pool when it is
+  ///        destroyed, unless discard() is called, e.g. after an error on the socket.
+  class connection
+  {
+  public:
+    connection() noexcept = default;
+
+    connection(connection_pool* pool, const socket_address& address, Socket socket) noexcept
+    :mp_pool{pool}
+    ,m_address{address}
+    ,m_socket{std::move(socket)}
+    {}
+
+    connection(connection&& other) noexcept
+    :mp_pool{std::exchange(other.mp_pool, nullptr)}
+    ,m_address{other.m_address}
+    ,m_socket{std::move(other.m_socket)}
+    ,m_reusable{other.m_reusable}
+    {}
+
+    connection& operator=(connection&& other) noexcept
+    {
+      if(this != &other)
+      {
+        release();
+        mp_pool    = std::exchange(other.mp_pool, nullptr);
+        m_address  = other.m_address;
+        m_reusable = other.m_reusable;
+        // sockets are move constructible only.
+        m_socket.reset();
+        if(other.m_socket)
+        {
+          m_socket.emplace(std::move(*other.m_socket));
+        }
+      }
+      return *this;
+    }
+
+    ~connection()
+    {
+      release();
+    }
+
+    explicit operator bool() const noexcept
+    {
+      return mp_pool != nullptr;
+    }
+
+    Socket& socket() noexcept { return *m_socket; }
+    Socket* operator->() noexcept { return &*m_socket; }
+
+    const socket_address& address() const noexcept { return m_address; }
+
+    /// \brief close the connection instead of returning it to the pool.
+    void discard() noexcept
+    {
+      m_reusable = false;
+    }
+
+    /// \brief return the connection to the pool now.
+    void release() noexcept
+    {
+      if(auto* pool = std::exchange(mp_pool, nullptr); pool)
+      {
+        pool->release(m_address, std::move(*m_socket), m_reusable);
+        m_socket.reset();
+      }
+    }
+
+  private:
+    connection_pool* mp_pool = nullptr;
+    socket_address m_address;
+    std::optional<Socket> m_socket;
+    bool m_reusable = true;
+  };
+
+  explicit connection_pool(io_service& service, connection_pool_options options = {})
+  :m_service{service}
+  ,m_options{std::move(options)}
+  {}
+
+  connection_pool(const connection_pool&) = delete;
+  connection_pool& operator=(const connection_pool&) = delete;
+
+  /// \brief check out a connection to address: an idle one if there is one, a new one if the
+  ///        backend is below max_connections, otherwise wait for one to be released.
+  /// \param[out] error will be reset if the connection can not be established. The returned
+  ///             connection is empty then.
+  auto acquire(const socket_address& address, std::error_code& error) -> task<connection>
+  {
+    error.clear();
+    auto& b = m_backends[address];
+
+    for(;;)
+    {
+      while(!b.m_idle.empty())
+      {
+        auto socket = std::move(b.m_idle.back().m_socket);
+        b.m_idle.pop_back();
+        if(is_alive(socket))
+        {
+          co_return connection{this, address, std::move(socket)};
+        }
+        --b.m_connections;
+      }
+
+      if(b.m_connections < m_options.max_connections)
+      {
+        ++b.m_connections;
+        auto socket = co_await connect(address, error);
+        if(error)
+        {
+          --b.m_connections;
+          wake_one(b);
+          co_return connection{};
+        }
+        co_return connection{this, address, std::move(*socket)};
+      }
+
+      auto w = waiter{&m_service};
+      b.m_waiters.push_back(&w);
+      co_await w;
+      if(w.m_socket)
+      {
+        co_return connection{this, address, std::move(*w.m_socket)};
+      }
+    }
+  }
+
+  /// \brief same as acquire(address, error), but report the error by exception.
+  auto acquire(const socket_address& address) -> task<connection>
+  {
+    auto error = std::error_code{};
+    auto c = co_await acquire(address, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+    co_return c;
+  }
+
+  /// \brief open up to count connections to address concurrently and keep them idle, so
+  ///        that the first requests do not pay for the handshake.
+  /// \return the number of connections opened.
+  auto prewarm(const socket_address& address, std::size_t count) -> task<std::size_t>
+  {
+    auto& b = m_backends[address];
+    count = std::min({count,
+                      m_options.max_connections - std::min(m_options.max_connections, b.m_connections),
+                      m_options.max_idle_connections - std::min(m_options.max_idle_connections, b.m_idle.size())});
+    b.m_connections += count;
+
+    auto connect_one = [this, &address]() -> task<std::optional<Socket>>
+    {
+      auto error = std::error_code{};
+      co_return co_await connect(address, error);
+    };
+
+    auto connects = std::vector<task<std::optional<Socket>>>{};
+    connects.reserve(count);
+    for(auto i = std::size_t{}; i < count; ++i)
+    {
+      connects.push_back(connect_one());
+    }
+
+    auto opened = std::size_t{};
+    for(auto& socket : co_await when_all(std::move(connects)))
+    {
+      if(socket)
+      {
+        ++opened;
+        release(address, std::move(*socket), true);
+      }
+      else
+      {
+        --b.m_connections;
+        wake_one(b);
+      }
+    }
+    co_return opened;
+  }
+
+  /// \brief close the connections that have been idle for longer than idle_timeout.
+  /// \return the number of connections closed.
+  auto reap_idle() noexcept -> std::size_t
+  {
+    auto deadline = clock::now() - m_options.idle_timeout;
+    auto reaped = std::size_t{};
+    for(auto& [address, b] : m_backends)
+    {
+      // the front of the deque has been idle for the longest time.
+      while(!b.m_idle.empty() && b.m_idle.front().m_idle_since <= deadline)
+      {
+        b.m_idle.pop_front();
+        --b.m_connections;
+        ++reaped;
+        wake_one(b);
+      }
+    }
+    return reaped;
+  }
+
+  /// \brief call reap_idle() every reap_interval on the io_service timer until token is stopped.
+  auto run_reaper(std::stop_token token) -> task<>
+  {
+    while(!token.stop_requested())
+    {
+      co_await m_service.schedule(m_options.reap_interval);
+      reap_idle();
+    }
+  }
+
+  [[nodiscard]]
+  auto idle_connections(const socket_address& address) const noexcept -> std::size_t
+  {
+    auto it = m_backends.find(address);
+    return it == m_backends.end() ? 0 : it->second.m_idle.size();
+  }
+
+  /// \brief the number of connections to address, idle or in use.
+  [[nodiscard]]
+  auto connections(const socket_address& address) const noexcept -> std::size_t
+  {
+    auto it = m_backends.find(address);
+    return it == m_backends.end() ? 0 : it->second.m_connections;
+  }
+
+private:
+  auto connect(const socket_address& address, std::error_code& error) -> task<std::optional<Socket>>
+  {
+    auto socket = Socket{};
+    socket.init(error);
+    if(error)
+    {
+      co_return std::nullopt;
+    }
+
+    // a connection that fails to take the options is still usable.
+    auto option_error = std::error_code{};
+    socket.apply_connection_profile(m_options.profile, option_error);
+
+    co_await socket.connect(address, error);
+    if(error)
+    {
+      co_return std::nullopt;
+    }
+    co_return std::optional<Socket>{std::move(socket)};
+  }
+
+  /// \brief an idle connection is dead if the peer has closed it or sent something unexpected.
+  static bool is_alive(Socket& socket) noexcept
+  {
+    char c;
+    auto ret = ::recv(socket.get(), &c, 1, MSG_PEEK | MSG_DONTWAIT);
+    return ret < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+  }
+
+  void release(const socket_address& address, Socket socket, bool reusable) noexcept
+  {
+    auto& b = m_backends[address];
+
+    if(!reusable)
+    {
+      --b.m_connections;
+      wake_one(b);
+    }
+    else if(!b.m_waiters.empty())
+    {
+      auto* w = b.m_waiters.front();
+      b.m_waiters.pop_front();
+      w->m_socket.emplace(std::move(socket));
+      m_service.schedule_local(w);
+    }
+    else if(b.m_idle.size() < m_options.max_idle_connections)
+    {
+      b.m_idle.push_back(idle_connection{std::move(socket), clock::now()});
+    }
+    else
+    {
+      --b.m_connections;
+    }
+  }
+
+  /// \brief let the first waiter of b retry, as a connection slot became free.
+  void wake_one(backend& b) noexcept
+  {
+    if(!b.m_waiters.empty())
+    {
+      auto* w = b.m_waiters.front();
+      b.m_waiters.pop_front();
+      m_service.schedule_local(w);
+    }
+  }
+
+  io_service& m_service;
+  connection_pool_options m_options;
+  std::map<socket_address, backend> m_backends;
+};
+
+}
+
+#endif //XYNET_SOCKET_CONNECTION_POOL_H
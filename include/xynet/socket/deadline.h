@@ -0,0 +1,237 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_DEADLINE_H
+#define XYNET_SOCKET_DEADLINE_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <stop_token>
+#include <vector>
+#include <liburing.h>
+
+#include "xynet/io_service.h"
+#include "xynet/coroutine/task.h"
+
+namespace xynet
+{
+
+class connection_deadline;
+
+/// \brief the timer of every connection_deadline with the same timeout on one io_service,
+///        e.g. one list for the idle timeout and another for the write timeout.
+///        The deadlines are kept in a wheel of lists, one per granularity, by the time they
+///        may expire. A refresh only stores a timestamp. When sweep() reaches the list of a
+///        deadline, it expires if it has not been refreshed for timeout, otherwise it moves
+///        to the list of its new expiry. So an active connection is touched at most once per
+///        timeout, and only the expired connections submit a cancel.
+/// \note  not thread-safe, use one per io_service.
+class deadline_list
+{
+  using clock = std::chrono::steady_clock;
+
+public:
+  /// \param timeout      a connection expires after this long without a refresh.
+  /// \param granularity  how often run() sweeps the list. A deadline expires up to this
+  ///                     late, and a refresh is accurate up to this.
+  deadline_list(io_service& service,
+                std::chrono::milliseconds timeout,
+                std::chrono::milliseconds granularity = std::chrono::milliseconds{100}) noexcept
+  :m_service{service}
+  ,m_timeout{timeout}
+  ,m_granularity{granularity}
+  ,m_now{clock::now()}
+  ,m_swept_tick{tick(m_now)}
+  ,m_wheel(static_cast<std::size_t>(timeout / granularity) + 2)
+  {}
+
+  deadline_list(const deadline_list&) = delete;
+  deadline_list& operator=(const deadline_list&) = delete;
+
+  /// \brief expire the deadlines that have not been refreshed for timeout.
+  /// \return the number of deadlines expired.
+  std::size_t sweep(clock::time_point now = clock::now()) noexcept;
+
+  /// \brief call sweep() every granularity on the io_service timer until token is stopped.
+  auto run(std::stop_token token) -> task<>
+  {
+    while(!token.stop_requested())
+    {
+      co_await m_service.schedule(m_granularity);
+      sweep();
+    }
+  }
+
+  /// \brief the time of the last sweep, which is what a refresh records instead of
+  ///        reading the clock.
+  [[nodiscard]]
+  clock::time_point now() const noexcept
+  {
+    return m_now;
+  }
+
+  [[nodiscard]] std::chrono::milliseconds timeout() const noexcept { return m_timeout; }
+  [[nodiscard]] std::size_t size() const noexcept { return m_size; }
+
+private:
+  friend connection_deadline;
+  using bucket = std::list<connection_deadline*>;
+
+  [[nodiscard]]
+  std::int64_t tick(clock::time_point time) const noexcept
+  {
+    return time.time_since_epoch() / m_granularity;
+  }
+
+  bucket& bucket_of(clock::time_point expiry) noexcept
+  {
+    return m_wheel[static_cast<std::size_t>(tick(expiry)) % m_wheel.size()];
+  }
+
+  io_service& m_service;
+  std::chrono::milliseconds m_timeout;
+  std::chrono::milliseconds m_granularity;
+  clock::time_point m_now;
+  std::int64_t m_swept_tick;
+  std::vector<bucket> m_wheel;
+  std::size_t m_size = 0;
+};
+
+/// \brief a deadline of one connection. When it expires every operation in flight on the
+///        socket is canceled, so the coroutine waiting on e.g. recv_some() resumes with
+///        std::errc::operation_canceled and can tell the timeout by expired().
+///        It is armed on construction. To time a single operation, e.g. a write, disarm()
+///        it when the operation completes and refresh() it before the next one.
+class connection_deadline
+{
+  using clock = std::chrono::steady_clock;
+
+public:
+  template<typename F>
+  connection_deadline(deadline_list& list, F& socket) noexcept
+  :connection_deadline{list, socket.get()}
+  {}
+
+  connection_deadline(deadline_list& list, int fd) noexcept
+  :m_list{list}
+  ,m_fd{fd}
+  {
+    arm();
+  }
+
+  connection_deadline(const connection_deadline&) = delete;
+  connection_deadline& operator=(const connection_deadline&) = delete;
+
+  ~connection_deadline()
+  {
+    disarm();
+  }
+
+  /// \brief record activity on the connection, arming the deadline again if it was disarmed
+  ///        or has expired.
+  void refresh() noexcept
+  {
+    if(!m_armed)[[unlikely]]
+    {
+      arm();
+      return;
+    }
+    m_last_activity = m_list.now();
+  }
+
+  /// \brief stop the deadline until the next refresh().
+  void disarm() noexcept
+  {
+    if(m_armed)
+    {
+      m_bucket->erase(m_position);
+      --m_list.m_size;
+      m_armed = false;
+    }
+  }
+
+  [[nodiscard]] bool armed() const noexcept { return m_armed; }
+
+  /// \brief whether the operations on the connection have been canceled by this deadline.
+  ///        Cleared by refresh().
+  [[nodiscard]] bool expired() const noexcept { return m_expired; }
+
+private:
+  friend deadline_list;
+
+  void arm() noexcept
+  {
+    m_last_activity = m_list.now();
+    m_bucket = &m_list.bucket_of(m_last_activity + m_list.m_timeout);
+    m_position = m_bucket->insert(m_bucket->end(), this);
+    ++m_list.m_size;
+    m_armed = true;
+    m_expired = false;
+  }
+
+  void expire() noexcept
+  {
+    m_bucket->erase(m_position);
+    --m_list.m_size;
+    m_armed = false;
+    m_expired = true;
+    // the completion of the cancel itself is not waited for.
+    m_list.m_service.try_submit_io([fd = m_fd](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_cancel_fd(sqe, fd, IORING_ASYNC_CANCEL_ALL);
+      sqe->user_data = 0;
+    });
+  }
+
+  deadline_list& m_list;
+  int m_fd;
+  clock::time_point m_last_activity{};
+  deadline_list::bucket* m_bucket = nullptr;
+  deadline_list::bucket::iterator m_position{};
+  bool m_armed = false;
+  bool m_expired = false;
+};
+
+inline std::size_t deadline_list::sweep(clock::time_point now) noexcept
+{
+  m_now = std::max(m_now, now);
+  auto now_tick = tick(m_now);
+  // a full turn of the wheel visits every bucket.
+  auto first_tick = std::max(m_swept_tick, now_tick - static_cast<std::int64_t>(m_wheel.size()) + 1);
+  m_swept_tick = now_tick;
+
+  auto expired = std::size_t{};
+  for(auto t = first_tick; t <= now_tick; ++t)
+  {
+    // a deadline that may expire later in the current tick goes back into the same bucket,
+    // so walk a detached copy of it.
+    auto& current = m_wheel[static_cast<std::size_t>(t) % m_wheel.size()];
+    auto pending = bucket{};
+    pending.splice(pending.end(), current);
+
+    while(!pending.empty())
+    {
+      auto* deadline = pending.front();
+      auto expiry = deadline->m_last_activity + m_timeout;
+      if(expiry > m_now)
+      {
+        deadline->m_bucket = &bucket_of(expiry);
+        deadline->m_bucket->splice(deadline->m_bucket->end(), pending, deadline->m_position);
+      }
+      else
+      {
+        deadline->m_bucket = &pending;
+        deadline->expire();
+        ++expired;
+      }
+    }
+  }
+  return expired;
+}
+
+}
+
+#endif //XYNET_SOCKET_DEADLINE_H
@@ -5,6 +5,7 @@
 #ifndef XYNET_SOCKET_ADDRESS_H
 #define XYNET_SOCKET_ADDRESS_H
 
+#include <compare>
 #include "xynet/detail/endian.h"
 
 namespace xynet
@@ -77,16 +78,21 @@ public:
   }
 
   [[nodiscard]]
-  uint16_t port() const
+  uint16_t port() const noexcept
   {
     return ::ntohs(m_sockaddr.sin_port);
   } 
 
-  std::strong_ordering operator<=>(const socket_address& rhs) const
+  std::strong_ordering operator<=>(const socket_address& rhs) const noexcept
   {
-    if (auto cmp = this <=> &rhs; std::is_eq(cmp)) return cmp;
-    if (auto cmp = m_sockaddr.sin_addr.s_addr <=> rhs.m_sockaddr.sin_addr.s_addr; std::is_eq(cmp)) return cmp;
-    return m_sockaddr.sin_port <=> rhs.m_sockaddr.sin_port;
+    // compare in host byte order, so that addresses sort the way they read.
+    if (auto cmp = ::ntohl(m_sockaddr.sin_addr.s_addr) <=> ::ntohl(rhs.m_sockaddr.sin_addr.s_addr); std::is_neq(cmp)) return cmp;
+    return port() <=> rhs.port();
+  }
+
+  bool operator==(const socket_address& rhs) const noexcept
+  {
+    return std::is_eq(*this <=> rhs);
   }
 
 private:
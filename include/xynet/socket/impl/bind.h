@@ -7,6 +7,7 @@
 
 #include "xynet/file_descriptor.h"
 #include "xynet/socket/impl/address.h"
+#include "xynet/socket/impl/unix_address.h"
 #include "xynet/detail/sync_operation.h"
 
 namespace xynet
@@ -80,6 +81,42 @@ struct operation_bind
     }
   }
 
+  /// \brief      bind an AF_UNIX socket to given path, report the error using std::error_code.
+  ///
+  /// \param[in]  the address to which the socket will be bind. A path in the file system must not
+  ///             exist yet, bind(2) creates the socket file and it is not removed on close.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto bind(const unix_socket_address& address, std::error_code& error) -> void
+  {
+    detail::sync_operation
+    (
+      [
+       fd   = static_cast<F *>(this)->get(),
+       addr = reinterpret_cast<const ::sockaddr *>(address.as_sockaddr_un()),
+       size = address.size()
+      ]
+      ()
+      {
+        return ::bind(fd, addr, size);
+      },
+      []([[maybe_unused]]int ret){},
+      error
+    );
+  }
+
+  /// \brief      bind an AF_UNIX socket to given path, report the error by throwing
+  ///             an std::system_error with the std::error_code as the reason.
+  auto bind(const unix_socket_address& address) -> void
+  {
+    auto error = std::error_code{};
+    bind(address, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
 };
 
 }
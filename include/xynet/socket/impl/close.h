@@ -7,17 +7,26 @@
 
 #include <type_traits>
 #include <array>
+#include <chrono>
+#include <sys/socket.h>
 #include "xynet/buffer.h"
 #include "xynet/detail/async_operation.h"
 #include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/detail/timeout_storage.h"
 
 namespace xynet
 {
 
+/// how long close() keeps reading what the peer still sends after the socket is shut down,
+/// waiting for its FIN, before the socket is closed anyway.
+inline constexpr std::chrono::milliseconds default_close_linger = std::chrono::seconds{1};
+
+/// the sink of the bytes that close() reads while lingering. They are discarded, so one
+/// buffer is shared by all the sockets.
 struct null_buffer
 {
-  constexpr inline static std::size_t buffer_size = 1024;
-  inline static std::array<std::byte, buffer_size> buffer = std::array<std::byte, 1024>{};
+  constexpr inline static std::size_t buffer_size = 64 * 1024;
+  inline static std::array<std::byte, buffer_size> buffer = std::array<std::byte, buffer_size>{};
   static void * data() noexcept
   {
     return static_cast<void *>(buffer.data());
@@ -29,24 +38,84 @@ struct null_buffer
   }
 };
 
+/// \brief close a socket in up to three steps:
+///        1. linger: read and discard until the peer's FIN arrives, for at most the linger
+///           duration, so that closing with unread data does not reset the connection.
+///           Only connected stream sockets linger, and an abortive close skips it.
+///        2. cancel every operation still in flight on the fd(IORING_ASYNC_CANCEL_FD), so
+///           that the coroutines waiting on them resume with std::errc::operation_canceled.
+///        3. IORING_OP_CLOSE.
 template<typename Policy, typename F>
 class async_close : public async_operation<Policy, async_close<Policy, F>>
 {
 public:
-  template<typename... Args>
-  async_close(F& socket, Args&&... args) noexcept
+  async_close(F& socket, std::chrono::nanoseconds linger, bool abortive) noexcept
+  : async_operation<Policy, async_close<Policy, F>>
+    {&async_close::on_close_step_completed}
+  , m_socket{socket}
+  , m_linger{linger}
+  , m_abortive{abortive}
+  {}
+
+  async_close(F& socket, std::chrono::nanoseconds linger, bool abortive, std::error_code& error) noexcept
   : async_operation<Policy, async_close<Policy, F>>
-    {&async_close::on_recv_completed, std::forward<Args>(args)...}
+    {&async_close::on_close_step_completed, error}
   , m_socket{socket}
+  , m_linger{linger}
+  , m_abortive{abortive}
   {}
 
+  void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+  {
+    async_operation_base::set_awaiting_coroutine(awaiting_coroutine);
+
+    auto fd = m_socket.get();
+    if(!m_socket.valid())
+    {
+      // let close(2) report EBADF.
+      m_step = step::close;
+    }
+    else if(m_abortive)
+    {
+      auto linger = ::linger{.l_onoff = 1, .l_linger = 0};
+      ::setsockopt(fd, SOL_SOCKET, SO_LINGER, &linger, sizeof(linger));
+      m_step = step::cancel;
+    }
+    else
+    {
+      m_step = should_linger(fd) ? step::linger : step::cancel;
+      m_deadline = std::chrono::steady_clock::now() + m_linger;
+    }
+
+    submit_step();
+  }
+
 private:
+  enum class step
+  {
+    linger,
+    cancel,
+    close,
+  };
+
   auto initial_check() const noexcept
   {
-    return m_socket.valid();
+    return true;
   }
 
-  static void on_recv_completed(async_operation_base *base) noexcept
+  /// \brief only a connected stream socket receives a FIN to wait for.
+  static bool should_linger(int fd) noexcept
+  {
+    int type = 0;
+    auto len = static_cast<::socklen_t>(sizeof(type));
+    if(::getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) < 0 || type != SOCK_STREAM)
+    {
+      return false;
+    }
+    return ::shutdown(fd, SHUT_WR) == 0 || errno != ENOTCONN;
+  }
+
+  static void on_close_step_completed(async_operation_base *base) noexcept
   {
     auto *op = static_cast<async_close*>(base);
     op->update_result();
@@ -57,89 +126,163 @@ private:
   {
     return [this](::io_uring_sqe* sqe)
     {
-      ::io_uring_prep_recv(sqe, m_socket.get(),
-        null_buffer::data(), null_buffer::size(), 0);
+      switch(m_step)
+      {
+        case step::linger:
+          ::io_uring_prep_recv(sqe, m_socket.get(),
+            null_buffer::data(), null_buffer::size(), 0);
+          break;
+        case step::cancel:
+          ::io_uring_prep_cancel_fd(sqe, m_socket.get(), IORING_ASYNC_CANCEL_ALL);
+          break;
+        case step::close:
+          ::io_uring_prep_close(sqe, m_socket.get());
+          break;
+      }
 
       sqe->user_data = reinterpret_cast<uintptr_t>(this);
     };
   }
 
-  void update_result()
+  void submit_step() noexcept
   {
-    if(async_operation_base::get_error_code())[[unlikely]]
+    if(m_step == step::linger)
     {
-      async_operation_base::get_awaiting_coroutine().resume();
-    }
-    else if(async_operation_base::get_res() == 0)[[likely]]
-    {
-      async_operation_base::set_value(::close(m_socket.get()), async_operation_base::get_flags());
-      async_operation_base::get_awaiting_coroutine().resume();
+      auto remaining = m_deadline - std::chrono::steady_clock::now();
+      if(remaining <= std::chrono::steady_clock::duration::zero())
+      {
+        m_step = step::cancel;
+      }
+      else
+      {
+        m_linger_timeout = detail::timeout_storage<true>{remaining};
+        async_operation_base::get_service()->try_submit_io(try_start(), m_linger_timeout.get_timespec_ptr());
+        return;
+      }
     }
-    else[[unlikely]]
+
+    async_operation_base::get_service()->try_submit_io(try_start());
+  }
+
+  void update_result()
+  {
+    auto& error = async_operation_base::get_error_code();
+    switch(m_step)
     {
-      async_operation<Policy, async_close<Policy, F>>::submit();
+      case step::linger:
+        if(!error && async_operation_base::get_res() > 0)
+        {
+          submit_step();
+          return;
+        }
+        // EOF, an error, or the linger timed out.
+        error.clear();
+        m_step = step::cancel;
+        submit_step();
+        return;
+
+      case step::cancel:
+        // nothing to cancel(ENOENT) or a kernel without IORING_ASYNC_CANCEL_FD(EINVAL).
+        error.clear();
+        m_step = step::close;
+        submit_step();
+        return;
+
+      case step::close:
+        // the fd is released even if close(2) fails.
+        if(error != std::errc::bad_file_descriptor)
+        {
+          m_socket.set(-1);
+        }
+        async_operation_base::get_awaiting_coroutine().resume();
+        return;
     }
   }
 
   decltype(auto) get_result()
   noexcept (Policy::error_code_type::value)
   {
-    if constexpr (Policy::error_code_type::value)
-    {
-      return;
-    }
-    else
+    if constexpr (!Policy::error_code_type::value)
     {
       if(async_operation_base::get_error_code())[[unlikely]]
       {
         throw std::system_error{async_operation_base::get_error_code()};
       }
-      else[[likely]]
-      {
-        return;
-      }
     }
   }
+
   friend async_operation<Policy, async_close<Policy, F>>;
   F& m_socket;
+  std::chrono::nanoseconds m_linger;
+  bool m_abortive;
+  step m_step = step::linger;
+  std::chrono::steady_clock::time_point m_deadline{};
+  detail::timeout_storage<true> m_linger_timeout{std::chrono::nanoseconds::zero()};
 };
 
-template<typename F, typename... Args>
-async_close(F& socket, Args&&... args) noexcept
--> async_close<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
-
 template<typename F>
 struct operation_close
 {
-  /// \brief      Create an awaiter to close a socket. This operation will first read from
-  ///   the socket until it reads a 0(eof). Then it will call close(2) on the socket.
-  /// \param      args        
-  /// 
-  /// 1. Args is void: 
-  ///   The awaiter returned by the function will throw exception to report the error.
-  ///   A std::system_error constructed with the corresponding std::error_code will be 
-  ///   throwed if the accept operation is failed after being co_await'ed.
-  ///  
-  /// 2. Args is a Duration, i.e. std::chrono::duration<Rep, Period>. 
-  ///   This duration will be treated as the timeout for the operation. If the operation 
-  ///   does not finish within the given duration, the operation will be canneled and an error_code
-  ///   (std::errc::operation_canceled) will be returned. 
-  ///   Notice that the timeout is imposed on each single read operation separately.
-  ///   
-  /// 3. Args is an lvalue reference of a std::error_code
-  ///   The awaiter returned by the function will use std::error_code to report the error.
-  ///   Should there be an error in the operation, the std::error_code passed by lvalue reference will 
-  ///   be reset. Otherwise, it will be clear.
-  /// 
-  /// 4. Args are first a Duration, second an lvalue reference of a std::error_code
-  ///   The operation will have the features described in 2 and 3.
-  template<typename... Args>
+  /// \brief      Create an awaiter to close a socket gracefully. The socket is shut down for
+  ///   writing, then the bytes the peer still sends are read and discarded until its FIN
+  ///   arrives or default_close_linger passes, then every operation still in flight on the
+  ///   socket is canceled, and at last the socket is closed with IORING_OP_CLOSE.
+  ///   The awaiter will throw exception to report the error of close(2).
   [[nodiscard]]
-  decltype(auto) close(Args&&... args) noexcept 
+  decltype(auto) close() noexcept
   {
-    return async_close{*static_cast<F*>(this), std::forward<Args>(args)...};
+    using policy = async_operation_traits<>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this), default_close_linger, false};
   }
 
+  /// \brief same as close(), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  [[nodiscard]]
+  decltype(auto) close(std::error_code& error) noexcept
+  {
+    using policy = async_operation_traits<std::error_code>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this), default_close_linger, false, error};
+  }
+
+  /// \brief same as close(), but linger for at most the given duration instead of
+  ///        default_close_linger. A zero duration skips lingering.
+  template<DurationType Duration>
+  [[nodiscard]]
+  decltype(auto) close(Duration&& linger) noexcept
+  {
+    using policy = async_operation_traits<>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(linger), false};
+  }
+
+  /// \brief same as close(linger), but use std::error_code to report error.
+  template<DurationType Duration>
+  [[nodiscard]]
+  decltype(auto) close(Duration&& linger, std::error_code& error) noexcept
+  {
+    using policy = async_operation_traits<std::error_code>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this),
+      std::chrono::duration_cast<std::chrono::nanoseconds>(linger), false, error};
+  }
+
+  /// \brief      Create an awaiter to close a socket abortively: SO_LINGER is set to 0, so that
+  ///   the connection is reset and released without lingering or going through TIME_WAIT, and
+  ///   the unsent data is dropped. Meant for shedding load, not for the normal close path.
+  [[nodiscard]]
+  decltype(auto) abortive_close() noexcept
+  {
+    using policy = async_operation_traits<>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this), std::chrono::nanoseconds::zero(), true};
+  }
+
+  /// \brief same as abortive_close(), but use std::error_code to report error.
+  [[nodiscard]]
+  decltype(auto) abortive_close(std::error_code& error) noexcept
+  {
+    using policy = async_operation_traits<std::error_code>::policy_type;
+    return async_close<policy, F>{*static_cast<F*>(this), std::chrono::nanoseconds::zero(), true, error};
+  }
 };
 
 }
@@ -6,19 +6,22 @@
 #define XYNET_SOCKET_CONNECT_H
 
 #include "xynet/detail/async_operation.h"
+#include "xynet/socket/impl/address.h"
+#include "xynet/socket/impl/unix_address.h"
 
 namespace xynet
 {
 
-template<typename Policy, typename F>
-class async_connect : public async_operation<Policy, async_connect<Policy, F>>
+template<typename Policy, typename F, typename SockAddr = ::sockaddr_in>
+class async_connect : public async_operation<Policy, async_connect<Policy, F, SockAddr>>
 {
 public:
   template<typename... Args>
-  async_connect(F& socket, sockaddr_in addr, Args&&... args) noexcept
-  : async_operation<Policy, async_connect<Policy, F>>{std::forward<Args>(args)...}
+  async_connect(F& socket, SockAddr addr, ::socklen_t addrlen, Args&&... args) noexcept
+  : async_operation<Policy, async_connect<Policy, F, SockAddr>>{std::forward<Args>(args)...}
   , m_socket{socket}
   , m_addr{addr}
+  , m_addrlen{addrlen}
   {}
 private:
   auto initial_check() const noexcept
@@ -44,7 +47,8 @@ private:
   {
     if (!async_operation_base::get_error_code())[[likely]]
     {
-      if constexpr(file_descriptor_has_module_v<std::decay_t<F>, xynet::template address>)
+      if constexpr(std::is_same_v<SockAddr, ::sockaddr_in>
+                && file_descriptor_has_module_v<std::decay_t<F>, xynet::template address>)
       {
         m_socket.set_peer_address(socket_address{m_addr});
       }
@@ -58,15 +62,15 @@ private:
     }
   }
 
-  friend async_operation<Policy, async_connect<Policy, F>>;
+  friend async_operation<Policy, async_connect<Policy, F, SockAddr>>;
   F&  m_socket;
-  ::sockaddr_in m_addr;
-  ::socklen_t m_addrlen = sizeof(::sockaddr_in);
+  SockAddr m_addr;
+  ::socklen_t m_addrlen;
 };
 
-template<typename F, typename... Args>
-async_connect(F& socket, sockaddr_in addr, Args&&... args) noexcept
--> async_connect<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
+template<typename F, typename SockAddr, typename... Args>
+async_connect(F& socket, SockAddr addr, ::socklen_t addrlen, Args&&... args) noexcept
+-> async_connect<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F, SockAddr>;
 
 template<typename F>
 struct operation_connect
@@ -97,7 +101,18 @@ struct operation_connect
   [[nodiscard]]
   decltype(auto) connect(const socket_address& address, Args&&... args) noexcept 
   {
-    return async_connect{*static_cast<F*>(this), *address.as_sockaddr_in(), std::forward<Args>(args)...};
+    return async_connect{*static_cast<F*>(this), *address.as_sockaddr_in(),
+                         ::socklen_t{sizeof(::sockaddr_in)}, std::forward<Args>(args)...};
+  }
+
+  /// \brief      Create an awaiter to connect an AF_UNIX socket to the socket bound to the given path.
+  /// \param      args the same as connect(const socket_address& address, Args&&... args).
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) connect(const unix_socket_address& address, Args&&... args) noexcept
+  {
+    return async_connect{*static_cast<F*>(this), *address.as_sockaddr_un(),
+                         address.size(), std::forward<Args>(args)...};
   }
 };
 
@@ -0,0 +1,328 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_CONNECT_ANY_H
+#define XYNET_SOCKET_CONNECT_ANY_H
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <span>
+#include <unistd.h>
+#include <liburing.h>
+
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/timeout_storage.h"
+#include "xynet/socket/impl/address.h"
+
+namespace xynet
+{
+
+/// the delay before connect_any() starts the next attempt while the earlier ones are pending.
+inline constexpr auto default_connect_stagger = std::chrono::milliseconds{250};
+
+/// connect_any() tries at most this many addresses, the rest are ignored.
+inline constexpr std::size_t max_connect_any_attempts = 8;
+
+/// \brief connect to whichever of several addresses answers first, e.g. the replicas of a
+///        backend. The first attempt starts right away and every stagger, or as soon as the
+///        pending ones have failed, another one starts. Each connect carries a linked timeout
+///        for what is left of the deadline. The first attempt to connect wins, the others
+///        are canceled and their sockets closed.
+///
+///        The attempts live in the awaiter, so there is no allocation per attempt. The
+///        operation completes once every sqe it submitted has completed.
+template<typename Policy, typename F>
+class async_connect_any : public async_operation<Policy, async_connect_any<Policy, F>>
+{
+  using base_type = async_operation<Policy, async_connect_any<Policy, F>>;
+  using clock     = std::chrono::steady_clock;
+
+  // the completion of one sqe of the operation, a connect attempt or the stagger timer.
+  struct step : public async_operation_base
+  {
+    // bound when the operation is awaited, as the awaiter may be moved before that.
+    void bind(async_connect_any* op) noexcept
+    {
+      async_operation_base::set_callback(&async_connect_any::on_step_completed);
+      async_operation_base::set_error_ptr(&m_error);
+      mp_op = op;
+    }
+
+    async_connect_any* mp_op = nullptr;
+    std::error_code m_error;
+    ::sockaddr_in m_addr{};
+    // read by the kernel when the sqe is submitted, not when it is prepared.
+    detail::timeout_storage<true> m_timeout{std::chrono::milliseconds::zero()};
+    int m_fd = -1;
+    bool m_in_flight = false;
+  };
+
+public:
+  template<typename... Args>
+  async_connect_any(F& socket, std::span<const socket_address> addresses,
+                    std::chrono::milliseconds deadline, std::chrono::milliseconds stagger,
+                    Args&&... args) noexcept
+  : base_type{std::forward<Args>(args)...}
+  , m_socket{socket}
+  , m_attempt_count{std::min(addresses.size(), max_connect_any_attempts)}
+  , m_deadline{deadline}
+  , m_stagger{stagger}
+  {
+    for(auto i = std::size_t{}; i < m_attempt_count; ++i)
+    {
+      m_attempts[i].m_addr = *addresses[i].as_sockaddr_in();
+    }
+  }
+
+  ~async_connect_any()
+  {
+    for(auto& attempt : m_attempts)
+    {
+      if(attempt.m_fd != -1)
+      {
+        ::close(attempt.m_fd);
+      }
+    }
+  }
+
+  void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+  {
+    async_operation_base::set_awaiting_coroutine(awaiting_coroutine);
+    async_operation_base::get_error_code().clear();
+
+    m_start = clock::now();
+    m_timer.bind(this);
+    for(auto& attempt : m_attempts)
+    {
+      attempt.bind(this);
+    }
+
+    start_next();
+    if(m_in_flight == 0)
+    {
+      finish();
+    }
+  }
+
+private:
+  friend base_type;
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  static void on_step_completed(async_operation_base* base) noexcept
+  {
+    auto* s = static_cast<step*>(base);
+    s->mp_op->update(*s);
+  }
+
+  void update(step& s) noexcept
+  {
+    s.m_in_flight = false;
+    --m_in_flight;
+
+    if(&s == &m_timer)
+    {
+      // expired, rather than canceled by a winner or the last attempt.
+      if(s.get_res() == -ETIME && m_winner == nullptr)
+      {
+        start_next();
+      }
+    }
+    else if(!s.m_error && m_winner == nullptr)
+    {
+      m_winner = &s;
+      cancel_pending();
+    }
+    else if(s.m_error)
+    {
+      if(s.m_error != std::errc::operation_canceled)
+      {
+        m_last_error = s.m_error;
+      }
+      if(m_winner == nullptr)
+      {
+        // do not wait for the stagger when nothing else is pending.
+        if(std::none_of(m_attempts.begin(), m_attempts.begin() + m_started,
+                        [](const step& attempt){ return attempt.m_in_flight; }))
+        {
+          start_next();
+        }
+      }
+    }
+
+    if(m_in_flight == 0)
+    {
+      finish();
+    }
+  }
+
+  void start_next() noexcept
+  {
+    auto remaining = m_deadline - std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - m_start);
+    if(m_started == m_attempt_count || remaining <= std::chrono::milliseconds::zero())
+    {
+      cancel_timer();
+      return;
+    }
+
+    auto& attempt = m_attempts[m_started++];
+    attempt.m_fd = ::socket(F::socket_domain, F::socket_type, F::socket_protocol);
+    if(attempt.m_fd == -1)
+    {
+      m_last_error.assign(errno, std::system_category());
+      start_next();
+      return;
+    }
+
+    attempt.m_timeout = detail::timeout_storage<true>{remaining};
+    async_operation_base::get_service()->try_submit_io([&attempt](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_connect(sqe, attempt.m_fd,
+                              reinterpret_cast<::sockaddr*>(&attempt.m_addr), sizeof(attempt.m_addr));
+      sqe->user_data = reinterpret_cast<uintptr_t>(&attempt);
+    }, attempt.m_timeout.get_timespec_ptr());
+    attempt.m_in_flight = true;
+    ++m_in_flight;
+
+    // one timer at a time, started with the attempt it will follow.
+    if(m_started < m_attempt_count && !m_timer.m_in_flight)
+    {
+      m_stagger_timeout = detail::timeout_storage<true>{m_stagger};
+      async_operation_base::get_service()->try_submit_io([this](::io_uring_sqe* sqe)
+      {
+        ::io_uring_prep_timeout(sqe, m_stagger_timeout.get_timespec_ptr(), 0, 0);
+        sqe->user_data = reinterpret_cast<uintptr_t>(&m_timer);
+      });
+      m_timer.m_in_flight = true;
+      ++m_in_flight;
+    }
+    else if(m_started == m_attempt_count)
+    {
+      cancel_timer();
+    }
+  }
+
+  void cancel(step& s) noexcept
+  {
+    if(s.m_in_flight)
+    {
+      // the completion of the cancel itself is not waited for.
+      async_operation_base::get_service()->try_submit_io([&s](::io_uring_sqe* sqe)
+      {
+        ::io_uring_prep_cancel(sqe, &s, 0);
+        sqe->user_data = 0;
+      });
+    }
+  }
+
+  void cancel_timer() noexcept
+  {
+    cancel(m_timer);
+  }
+
+  void cancel_pending() noexcept
+  {
+    cancel_timer();
+    for(auto i = std::size_t{}; i < m_started; ++i)
+    {
+      cancel(m_attempts[i]);
+    }
+  }
+
+  void finish() noexcept
+  {
+    if(m_winner != nullptr)
+    {
+      if(auto fd = m_socket.get(); fd != -1)
+      {
+        ::close(fd);
+      }
+      m_socket.set(std::exchange(m_winner->m_fd, -1));
+      if constexpr(file_descriptor_has_module_v<std::decay_t<F>, xynet::template address>)
+      {
+        m_socket.set_peer_address(socket_address{m_winner->m_addr});
+      }
+    }
+    else if(m_last_error)
+    {
+      async_operation_base::get_error_code() = m_last_error;
+    }
+    else if(m_attempt_count == 0)
+    {
+      async_operation_base::get_error_code() = std::make_error_code(std::errc::invalid_argument);
+    }
+    else
+    {
+      // every attempt was canceled by its linked timeout.
+      async_operation_base::get_error_code() = std::make_error_code(std::errc::timed_out);
+    }
+    async_operation_base::get_awaiting_coroutine().resume();
+  }
+
+  decltype(auto) get_result()
+  noexcept (Policy::error_code_type::value)
+  {
+    if constexpr (!Policy::error_code_type::value)
+    {
+      if (async_operation_base::get_error_code())[[unlikely]]
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+  }
+
+  F& m_socket;
+  std::array<step, max_connect_any_attempts> m_attempts{};
+  std::size_t m_attempt_count;
+  std::size_t m_started = 0;
+  step m_timer;
+  detail::timeout_storage<true> m_stagger_timeout{std::chrono::milliseconds::zero()};
+  unsigned int m_in_flight = 0;
+  step* m_winner = nullptr;
+  std::error_code m_last_error;
+  std::chrono::milliseconds m_deadline;
+  std::chrono::milliseconds m_stagger;
+  clock::time_point m_start;
+};
+
+template<typename F>
+struct operation_connect_any
+{
+  /// \brief      Create an awaiter to connect the socket to the first of addresses that accepts
+  ///             the connection within deadline, trying them in order with a stagger between
+  ///             the attempts. See async_connect_any. The open socket, if any, is closed once
+  ///             an attempt has won.
+  /// \param      args  nothing to report error by exception, or an lvalue reference of a
+  ///                   std::error_code. The error is the one of the last attempt to fail, or
+  ///                   std::errc::timed_out if none connected within deadline.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) connect_any(std::span<const socket_address> addresses,
+                             std::chrono::milliseconds deadline,
+                             Args&... args) noexcept
+  {
+    return connect_any(addresses, deadline, default_connect_stagger, args...);
+  }
+
+  /// \brief      Same as connect_any(addresses, deadline, args...), with the given stagger.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) connect_any(std::span<const socket_address> addresses,
+                             std::chrono::milliseconds deadline,
+                             std::chrono::milliseconds stagger,
+                             Args&... args) noexcept
+  {
+    using policy_type = typename async_operation_traits<std::decay_t<Args>...>::policy_type;
+    return async_connect_any<policy_type, F>{*static_cast<F*>(this), addresses, deadline, stagger, args...};
+  }
+};
+
+}
+
+#endif //XYNET_SOCKET_CONNECT_ANY_H
@@ -0,0 +1,749 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_DATAGRAM_H
+#define XYNET_SOCKET_DATAGRAM_H
+
+#include <vector>
+#include <cstring>
+#include <netinet/udp.h>
+#include "xynet/buffer.h"
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/detail/sync_operation.h"
+#include "xynet/socket/impl/address.h"
+#include "xynet/socket/impl/send_all.h"
+#include "xynet/socket/impl/recv_all.h"
+
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+
+namespace xynet
+{
+
+namespace detail
+{
+
+// room for one UDP_GRO control message.
+struct alignas(::cmsghdr) datagram_control
+{
+  std::byte m_data[CMSG_SPACE(sizeof(int))];
+};
+
+// the size of the segments a GRO datagram is made of, or 0 if the datagram is not coalesced.
+inline auto gro_segment_size(const ::msghdr& msg) noexcept -> std::size_t
+{
+  if(msg.msg_control == nullptr)
+  {
+    return 0;
+  }
+  for(auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<::msghdr*>(&msg), cmsg))
+  {
+    if(cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO)
+    {
+      auto segment_size = int{};
+      std::memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+      return static_cast<std::size_t>(segment_size);
+    }
+  }
+  return 0;
+}
+
+}
+
+struct received_datagram
+{
+  std::size_t bytes;
+  /// \brief with UDP_GRO enabled, the datagram may be several datagrams of segment_size bytes
+  ///        (the last one may be shorter) coalesced by the kernel. 0 if it is not coalesced.
+  std::size_t segment_size;
+};
+
+/// \brief a batch of datagrams for send_batch() and recv_batch(). The buffers of each datagram are given
+///        the same way as for send()/recv(), and the batch keeps the iovecs, addresses and control
+///        messages of all the datagrams in a few contiguous arrays that are reused after clear().
+class datagram_batch
+{
+public:
+  explicit datagram_batch(std::size_t capacity = 64)
+  {
+    m_slots.reserve(capacity);
+    m_msgs.reserve(capacity);
+  }
+
+  /// \brief add a datagram to send to the given address.
+  template<typename... Buffers>
+  auto push(const socket_address& address, Buffers&&... buffers) -> void
+  {
+    auto sequence = const_buffer_sequence{std::forward<Buffers>(buffers)...};
+    push_slot(address, true, sequence.get_iov_span());
+  }
+
+  /// \brief add buffers to receive one datagram into.
+  template<typename... Buffers>
+  auto prepare(Buffers&&... buffers) -> void
+  {
+    auto sequence = buffer_sequence{std::forward<Buffers>(buffers)...};
+    push_slot(socket_address{}, false, sequence.get_iov_span());
+  }
+
+  auto clear() noexcept -> void
+  {
+    m_slots.clear();
+    m_iov.clear();
+    m_msgs.clear();
+  }
+
+  [[nodiscard]]
+  auto size() const noexcept
+  {
+    return m_slots.size();
+  }
+
+  [[nodiscard]]
+  auto empty() const noexcept
+  {
+    return m_slots.empty();
+  }
+
+  /// \brief the bytes sent or received by the i-th datagram.
+  [[nodiscard]]
+  auto bytes(std::size_t i) const noexcept -> std::size_t
+  {
+    return m_msgs[i].msg_len;
+  }
+
+  /// \brief the source address of the i-th received datagram, or the destination of the i-th sent datagram.
+  [[nodiscard]]
+  auto address(std::size_t i) const noexcept -> const socket_address&
+  {
+    return m_slots[i].m_address;
+  }
+
+  /// \brief the GRO segment size of the i-th received datagram, see received_datagram.
+  [[nodiscard]]
+  auto segment_size(std::size_t i) const noexcept -> std::size_t
+  {
+    return detail::gro_segment_size(m_msgs[i].msg_hdr);
+  }
+
+  /// \brief used by the batch operations. Fill in the ::mmsghdr's, which point into the storage of the batch.
+  auto prepare_msgs() noexcept -> ::mmsghdr*
+  {
+    m_msgs.resize(m_slots.size());
+    for(auto i = std::size_t{}; i < m_slots.size(); ++i)
+    {
+      auto& slot = m_slots[i];
+      slot.m_control = {};
+      m_msgs[i] = ::mmsghdr
+      {
+        .msg_hdr = ::msghdr
+        {
+          .msg_name       = const_cast<::sockaddr_in*>(slot.m_address.as_sockaddr_in()),
+          .msg_namelen    = sizeof(::sockaddr_in),
+          .msg_iov        = m_iov.data() + slot.m_iov_begin,
+          .msg_iovlen     = slot.m_iov_count,
+          .msg_control    = slot.m_send ? nullptr : slot.m_control.m_data,
+          .msg_controllen = slot.m_send ? 0 : sizeof(slot.m_control.m_data)
+        },
+        .msg_len = 0
+      };
+    }
+    return m_msgs.data();
+  }
+
+private:
+  struct slot
+  {
+    socket_address m_address;
+    std::size_t m_iov_begin;
+    std::size_t m_iov_count;
+    bool m_send;
+    detail::datagram_control m_control;
+  };
+
+  template<typename IovSpan>
+  auto push_slot(const socket_address& address, bool send, IovSpan iov_span) -> void
+  {
+    auto [iov, cnt] = iov_span;
+    m_slots.push_back(slot{
+      .m_address   = address,
+      .m_iov_begin = m_iov.size(),
+      .m_iov_count = static_cast<std::size_t>(cnt),
+      .m_send      = send,
+      .m_control   = {}});
+    m_iov.insert(m_iov.end(), iov, iov + cnt);
+  }
+
+  std::vector<slot> m_slots;
+  std::vector<::iovec> m_iov;
+  std::vector<::mmsghdr> m_msgs;
+};
+
+template<typename Policy, typename F>
+struct async_sendto : public async_operation<Policy, async_sendto<Policy, F>>
+{
+  template<typename... Args>
+  async_sendto(F& socket, const socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_sendto<Policy, F>>{}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<typename... Args>
+  async_sendto(F& socket, std::error_code& error, const socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_sendto<Policy, F>>{error}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_sendto(F& socket, Duration&& duration, const socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_sendto<Policy, F>>{std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_sendto(F& socket, Duration&& duration, std::error_code& error,
+               const socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_sendto<Policy, F>>{std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      m_msghdr = ::msghdr
+      {
+        .msg_name    = const_cast<::sockaddr_in*>(m_address.as_sockaddr_in()),
+        .msg_namelen = sizeof(::sockaddr_in),
+        .msg_iov     = m_buffers.get_iov_ptr(),
+        .msg_iovlen  = m_buffers.get_iov_cnt()
+      };
+      ::io_uring_prep_sendmsg(sqe, m_socket.get(), &m_msghdr, MSG_NOSIGNAL);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if(!async_operation_base::get_error_code())[[likely]]
+    {
+      return static_cast<std::size_t>(async_operation_base::get_res());
+    }
+
+    if constexpr (!Policy::error_code_type::value)
+    {
+      throw std::system_error{async_operation_base::get_error_code()};
+    }
+    return 0;
+  }
+
+private:
+  F& m_socket;
+  socket_address m_address;
+  Policy::buffer_type m_buffers;
+  ::msghdr m_msghdr = ::msghdr{};
+};
+
+template<typename Policy, typename F>
+struct async_recvfrom : public async_operation<Policy, async_recvfrom<Policy, F>>
+{
+  template<typename... Args>
+  async_recvfrom(F& socket, socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_recvfrom<Policy, F>>{}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<typename... Args>
+  async_recvfrom(F& socket, std::error_code& error, socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_recvfrom<Policy, F>>{error}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_recvfrom(F& socket, Duration&& duration, socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_recvfrom<Policy, F>>{std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_recvfrom(F& socket, Duration&& duration, std::error_code& error,
+                 socket_address& address, Args&&... args) noexcept
+  :async_operation<Policy, async_recvfrom<Policy, F>>{std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_address{address}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      m_control = {};
+      m_msghdr = ::msghdr
+      {
+        .msg_name       = &m_peer,
+        .msg_namelen    = sizeof(m_peer),
+        .msg_iov        = m_buffers.get_iov_ptr(),
+        .msg_iovlen     = m_buffers.get_iov_cnt(),
+        .msg_control    = m_control.m_data,
+        .msg_controllen = sizeof(m_control.m_data)
+      };
+      ::io_uring_prep_recvmsg(sqe, m_socket.get(), &m_msghdr, 0);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> received_datagram
+  {
+    if(!async_operation_base::get_error_code())[[likely]]
+    {
+      m_address = socket_address{m_peer};
+      return received_datagram
+      {
+        .bytes        = static_cast<std::size_t>(async_operation_base::get_res()),
+        .segment_size = detail::gro_segment_size(m_msghdr)
+      };
+    }
+
+    if constexpr (!Policy::error_code_type::value)
+    {
+      throw std::system_error{async_operation_base::get_error_code()};
+    }
+    return received_datagram{};
+  }
+
+private:
+  F& m_socket;
+  socket_address& m_address;
+  Policy::buffer_type m_buffers;
+  ::sockaddr_in m_peer = ::sockaddr_in{};
+  detail::datagram_control m_control = {};
+  ::msghdr m_msghdr = ::msghdr{};
+};
+
+template<typename Policy, typename F>
+class async_recv_batch : public async_operation<Policy, async_recv_batch<Policy, F>>
+{
+public:
+  template<typename... Args>
+  async_recv_batch(F& socket, datagram_batch& batch, Args&&... args) noexcept
+  :async_operation<Policy, async_recv_batch<Policy, F>>{&async_recv_batch::on_recv_completed, std::forward<Args>(args)...}
+  ,m_socket{socket}
+  ,m_batch{batch}
+  {}
+
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  // io_uring has no recvmmsg. Wait for the first datagram with an async recvmsg, then
+  // drain whatever else is already queued with one non-blocking recvmmsg(2).
+  static void on_recv_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_recv_batch*>(base);
+    if(!op->get_error_code())
+    {
+      op->m_msgs[0].msg_len = static_cast<unsigned int>(op->get_res());
+      op->m_received = 1;
+      if(auto size = op->m_batch.size(); size > 1)
+      {
+        auto ret = ::recvmmsg(op->m_socket.get(), op->m_msgs + 1,
+                              static_cast<unsigned int>(size - 1), MSG_DONTWAIT, nullptr);
+        if(ret > 0)
+        {
+          op->m_received += static_cast<std::size_t>(ret);
+        }
+      }
+    }
+    async_operation_base::on_operation_completed(base);
+  }
+
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      m_msgs = m_batch.prepare_msgs();
+      ::io_uring_prep_recvmsg(sqe, m_socket.get(), &m_msgs[0].msg_hdr, 0);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (!Policy::error_code_type::value)
+    {
+      if(auto& error = async_operation_base::get_error_code(); error)
+      {
+        throw std::system_error{error};
+      }
+    }
+    return m_received;
+  }
+
+  friend async_operation<Policy, async_recv_batch<Policy, F>>;
+  F& m_socket;
+  datagram_batch& m_batch;
+  ::mmsghdr* m_msgs = nullptr;
+  std::size_t m_received = 0;
+};
+
+template<typename F, typename... Args>
+async_recv_batch(F& socket, datagram_batch& batch, Args&&... args) noexcept
+-> async_recv_batch<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
+
+template<typename Policy, typename F>
+class async_send_batch : public async_operation<Policy, async_send_batch<Policy, F>>
+{
+public:
+  template<typename... Args>
+  async_send_batch(F& socket, datagram_batch& batch, Args&&... args) noexcept
+  :async_operation<Policy, async_send_batch<Policy, F>>{&async_send_batch::on_send_completed, std::forward<Args>(args)...}
+  ,m_socket{socket}
+  ,m_batch{batch}
+  {}
+
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  // io_uring has no sendmmsg. Send one datagram with an async sendmsg, which waits for room in the
+  // socket buffer, then push as many of the rest as possible with one non-blocking sendmmsg(2).
+  // As for send(), an error after some of the datagrams are sent ends the operation with the
+  // number sent, and is left to the next send to report.
+  static void on_send_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_send_batch*>(base);
+    if(op->get_error_code())
+    {
+      if(op->m_sent > 0)
+      {
+        op->get_error_code().clear();
+      }
+      async_operation_base::on_operation_completed(base);
+      return;
+    }
+
+    op->m_msgs[op->m_sent].msg_len = static_cast<unsigned int>(op->get_res());
+    ++op->m_sent;
+    auto size = op->m_batch.size();
+    if(op->m_sent < size)
+    {
+      auto ret = ::sendmmsg(op->m_socket.get(), op->m_msgs + op->m_sent,
+                            static_cast<unsigned int>(size - op->m_sent), MSG_DONTWAIT | MSG_NOSIGNAL);
+      if(ret > 0)
+      {
+        op->m_sent += static_cast<std::size_t>(ret);
+      }
+      else if(ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+      {
+        async_operation_base::on_operation_completed(base);
+        return;
+      }
+    }
+
+    if(op->m_sent < size)
+    {
+      op->submit();
+      return;
+    }
+    async_operation_base::on_operation_completed(base);
+  }
+
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      if(m_msgs == nullptr)
+      {
+        m_msgs = m_batch.prepare_msgs();
+      }
+      ::io_uring_prep_sendmsg(sqe, m_socket.get(), &m_msgs[m_sent].msg_hdr, MSG_NOSIGNAL);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (!Policy::error_code_type::value)
+    {
+      if(auto& error = async_operation_base::get_error_code(); error)
+      {
+        throw std::system_error{error};
+      }
+    }
+    return m_sent;
+  }
+
+  friend async_operation<Policy, async_send_batch<Policy, F>>;
+  F& m_socket;
+  datagram_batch& m_batch;
+  ::mmsghdr* m_msgs = nullptr;
+  std::size_t m_sent = 0;
+};
+
+template<typename F, typename... Args>
+async_send_batch(F& socket, datagram_batch& batch, Args&&... args) noexcept
+-> async_send_batch<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F>;
+
+template<typename F>
+struct operation_datagram
+{
+  /// \brief      create an awaiter for sending one datagram to the given address with sendmsg(2).
+  /// \param[in]  address the destination of the datagram.
+  /// \param[in]  args buffers, with the same requirements as in send(Args&&... args). They are
+  ///             sent as one datagram, or as several datagrams if UDP_SEGMENT is set.
+  /// \note       After the operation is co_await'ed and then finish, it will return the bytes transferred.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_to(const socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<>
+      >;
+    return async_sendto<policy, F>
+      {*static_cast<F*>(this), address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_to(address, args...), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_to(std::error_code& error, const socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<std::error_code>
+      >;
+    return async_sendto<policy, F>
+      {*static_cast<F*>(this), error, address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_to(address, args...), but imposes a timout on the operation.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_to(Duration&& duration, const socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration>
+      >;
+    return async_sendto<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_to(address, args...), but imposes a timout on the operation and reports
+  ///        error by std::error_code
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_to(Duration&& duration, std::error_code& error,
+                         const socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration, std::error_code>
+      >;
+    return async_sendto<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), error, address, std::forward<Args>(args)...};
+  }
+
+  /// \brief      create an awaiter for receiving one datagram with recvmsg(2).
+  /// \param[out] address will be set to the source of the datagram.
+  /// \param[out] args buffers, with the same requirements as in recv(Args&&... args).
+  /// \note       After the operation is co_await'ed and then finish, it will return a received_datagram.
+  ///             A datagram larger than the buffers is truncated.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_from(socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<>
+      >;
+    return async_recvfrom<policy, F>
+      {*static_cast<F*>(this), address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_from(address, args...), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_from(std::error_code& error, socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<std::error_code>
+      >;
+    return async_recvfrom<policy, F>
+      {*static_cast<F*>(this), error, address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_from(address, args...), but imposes a timout on the operation.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_from(Duration&& duration, socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration>
+      >;
+    return async_recvfrom<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), address, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_from(address, args...), but imposes a timout on the operation and reports
+  ///        error by std::error_code
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_from(Duration&& duration, std::error_code& error,
+                           socket_address& address, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration, std::error_code>
+      >;
+    return async_recvfrom<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), error, address, std::forward<Args>(args)...};
+  }
+
+  /// \brief      create an awaiter for sending all the datagrams of a batch.
+  /// \param      args the same as the args of connect(address, args...): nothing, a Duration, an lvalue
+  ///             reference of a std::error_code, or both.
+  /// \note       - Datagrams are pushed with sendmmsg(2), so most of the batch costs one system call.
+  ///             - After the operation is co_await'ed and then finish, it will return the number of
+  ///               datagrams sent. batch.bytes(i) is the bytes sent by the i-th datagram.
+  ///             - An error is reported only if no datagram is sent. Otherwise the operation
+  ///               returns the number sent so far, which is less than batch.size().
+  ///             - The batch must hold at least one datagram.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_batch(datagram_batch& batch, Args&&... args) noexcept
+  {
+    return async_send_batch{*static_cast<F*>(this), batch, std::forward<Args>(args)...};
+  }
+
+  /// \brief      create an awaiter for receiving up to batch.size() datagrams into the buffers prepared
+  ///             in the batch.
+  /// \param      args the same as the args of connect(address, args...).
+  /// \note       - The operation waits for one datagram and then takes whatever else is queued on
+  ///               the socket with one recvmmsg(2).
+  ///             - After the operation is co_await'ed and then finish, it will return the number of
+  ///               datagrams received. batch.bytes(i), batch.address(i) and batch.segment_size(i)
+  ///               describe the i-th datagram.
+  ///             - The batch must hold at least one datagram.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_batch(datagram_batch& batch, Args&&... args) noexcept
+  {
+    return async_recv_batch{*static_cast<F*>(this), batch, std::forward<Args>(args)...};
+  }
+
+  /// \brief set UDP_SEGMENT (GSO): the kernel splits each send into datagrams of segment_size bytes.
+  ///        0 disables it. report error by error_code
+  auto udp_segment(uint16_t segment_size, std::error_code& error) noexcept -> void
+  {
+    set_udp_option(UDP_SEGMENT, segment_size, error);
+  }
+
+  /// \brief set UDP_SEGMENT (GSO). report error by exception
+  auto udp_segment(uint16_t segment_size) -> void
+  {
+    auto error = std::error_code{};
+    udp_segment(segment_size, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief set or clear UDP_GRO: the kernel may coalesce datagrams of the same flow into one
+  ///        receive, see received_datagram::segment_size. report error by error_code
+  auto udp_gro(bool enable, std::error_code& error) noexcept -> void
+  {
+    set_udp_option(UDP_GRO, enable, error);
+  }
+
+  /// \brief set or clear UDP_GRO. report error by exception
+  auto udp_gro(bool enable = true) -> void
+  {
+    auto error = std::error_code{};
+    udp_gro(enable, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+private:
+  auto set_udp_option(int optname, int optval, std::error_code& error) noexcept -> void
+  {
+    detail::sync_operation
+    (
+      [fd = static_cast<const F*>(this)->get(), optname, &optval]()
+      {
+        return ::setsockopt(fd, SOL_UDP, optname, &optval, sizeof(optval));
+      },
+      []([[maybe_unused]]int ret){},
+      error
+    );
+  }
+};
+
+}
+
+#endif //XYNET_SOCKET_DATAGRAM_H
@@ -0,0 +1,431 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_FD_PASSING_H
+#define XYNET_SOCKET_FD_PASSING_H
+
+#include <span>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "xynet/buffer.h"
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/socket/impl/send_all.h"
+#include "xynet/socket/impl/recv_all.h"
+
+namespace xynet
+{
+
+/// \brief the maximum number of file descriptors passed in one message.
+inline constexpr std::size_t max_passed_fds = 16;
+
+namespace detail
+{
+
+struct alignas(::cmsghdr) scm_rights_control
+{
+  std::byte m_data[CMSG_SPACE(sizeof(int) * max_passed_fds)];
+};
+
+}
+
+struct received_fds
+{
+  /// \brief the bytes of the ordinary data received along with the file descriptors.
+  std::size_t bytes;
+  /// \brief the number of file descriptors written to the span passed to recv_fds.
+  std::size_t fds;
+};
+
+template<typename Policy, typename F>
+struct async_send_fds : public async_operation<Policy, async_send_fds<Policy, F>>
+{
+  template<typename... Args>
+  async_send_fds(F& socket, std::span<const int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_send_fds<Policy, F>>{}
+  ,m_socket{socket}
+  ,m_buffers{std::forward<Args>(args)...}
+  {
+    init_control(fds);
+  }
+
+  template<typename... Args>
+  async_send_fds(F& socket, std::error_code& error, std::span<const int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_send_fds<Policy, F>>{error}
+  ,m_socket{socket}
+  ,m_buffers{std::forward<Args>(args)...}
+  {
+    init_control(fds);
+  }
+
+  template<DurationType Duration, typename... Args>
+  async_send_fds(F& socket, Duration&& duration, std::span<const int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_send_fds<Policy, F>>{std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_buffers{std::forward<Args>(args)...}
+  {
+    init_control(fds);
+  }
+
+  template<DurationType Duration, typename... Args>
+  async_send_fds(F& socket, Duration&& duration, std::error_code& error,
+                 std::span<const int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_send_fds<Policy, F>>{std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_buffers{std::forward<Args>(args)...}
+  {
+    init_control(fds);
+  }
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      if(m_fd_count > max_passed_fds)[[unlikely]]
+      {
+        ::io_uring_prep_nop(sqe);
+      }
+      else
+      {
+        // the iovecs and the control message live in the awaiter, which may have been moved
+        // since it was created.
+        m_msghdr = ::msghdr
+        {
+          .msg_iov        = m_buffers.get_iov_ptr(),
+          .msg_iovlen     = m_buffers.get_iov_cnt(),
+          .msg_control    = m_fd_count == 0 ? nullptr : m_control.m_data,
+          .msg_controllen = m_fd_count == 0 ? 0 : CMSG_SPACE(sizeof(int) * m_fd_count)
+        };
+        ::io_uring_prep_sendmsg(sqe, m_socket.get(), &m_msghdr, MSG_NOSIGNAL);
+      }
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if(m_fd_count > max_passed_fds)[[unlikely]]
+    {
+      async_operation_base::get_error_code() = std::make_error_code(std::errc::invalid_argument);
+    }
+
+    if(!async_operation_base::get_error_code())[[likely]]
+    {
+      return static_cast<std::size_t>(async_operation_base::get_res());
+    }
+
+    if constexpr (!Policy::error_code_type::value)
+    {
+      throw std::system_error{async_operation_base::get_error_code()};
+    }
+    return 0;
+  }
+
+private:
+  auto init_control(std::span<const int> fds) noexcept -> void
+  {
+    // more than max_passed_fds fails the operation rather than passing only some of them.
+    m_fd_count = fds.size();
+    if(m_fd_count == 0 || m_fd_count > max_passed_fds)
+    {
+      return;
+    }
+
+    auto* cmsg = reinterpret_cast<::cmsghdr*>(m_control.m_data);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type  = SCM_RIGHTS;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(int) * m_fd_count);
+    std::memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * m_fd_count);
+  }
+
+  F& m_socket;
+  Policy::buffer_type m_buffers;
+  detail::scm_rights_control m_control = {};
+  ::msghdr m_msghdr = ::msghdr{};
+  std::size_t m_fd_count = 0;
+};
+
+template<typename Policy, typename F>
+struct async_recv_fds : public async_operation<Policy, async_recv_fds<Policy, F>>
+{
+  template<typename... Args>
+  async_recv_fds(F& socket, std::span<int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_recv_fds<Policy, F>>{}
+  ,m_socket{socket}
+  ,m_fds{fds}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<typename... Args>
+  async_recv_fds(F& socket, std::error_code& error, std::span<int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_recv_fds<Policy, F>>{error}
+  ,m_socket{socket}
+  ,m_fds{fds}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_recv_fds(F& socket, Duration&& duration, std::span<int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_recv_fds<Policy, F>>{std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_fds{fds}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_recv_fds(F& socket, Duration&& duration, std::error_code& error,
+                 std::span<int> fds, Args&&... args) noexcept
+  :async_operation<Policy, async_recv_fds<Policy, F>>{std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_fds{fds}
+  ,m_buffers{std::forward<Args>(args)...}
+  {}
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      m_control = {};
+      m_msghdr = ::msghdr
+      {
+        .msg_iov        = m_buffers.get_iov_ptr(),
+        .msg_iovlen     = m_buffers.get_iov_cnt(),
+        .msg_control    = m_control.m_data,
+        .msg_controllen = CMSG_SPACE(sizeof(int) * std::min(m_fds.size(), max_passed_fds))
+      };
+      ::io_uring_prep_recvmsg(sqe, m_socket.get(), &m_msghdr, MSG_CMSG_CLOEXEC);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> received_fds
+  {
+    if(async_operation_base::get_error_code())[[unlikely]]
+    {
+      if constexpr (!Policy::error_code_type::value)
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+      return received_fds{};
+    }
+
+    auto result = received_fds{.bytes = static_cast<std::size_t>(async_operation_base::get_res()), .fds = 0};
+    // the padding of the control buffer may hold more than asked for, which is a truncation too.
+    auto truncated = (m_msghdr.msg_flags & MSG_CTRUNC) != 0;
+    for(auto* cmsg = CMSG_FIRSTHDR(&m_msghdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&m_msghdr, cmsg))
+    {
+      if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS)
+      {
+        auto received = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        auto* data = CMSG_DATA(cmsg);
+        for(auto i = std::size_t{}; i < received; ++i)
+        {
+          auto fd = int{};
+          std::memcpy(&fd, data + i * sizeof(int), sizeof(int));
+          if(result.fds < m_fds.size())
+          {
+            m_fds[result.fds++] = fd;
+          }
+          else
+          {
+            truncated = true;
+            ::close(fd);
+          }
+        }
+      }
+    }
+
+    if(truncated)[[unlikely]]
+    {
+      // some of the passed file descriptors were dropped, do not hand out the rest.
+      for(auto& fd : m_fds.first(result.fds))
+      {
+        ::close(std::exchange(fd, -1));
+      }
+      result.fds = 0;
+      async_operation_base::get_error_code() = std::make_error_code(std::errc::message_size);
+      if constexpr (!Policy::error_code_type::value)
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+    return result;
+  }
+
+private:
+  F& m_socket;
+  std::span<int> m_fds;
+  Policy::buffer_type m_buffers;
+  detail::scm_rights_control m_control = {};
+  ::msghdr m_msghdr = ::msghdr{};
+};
+
+template<typename F>
+struct operation_fd_passing
+{
+  /// \brief      create an awaiter for passing file descriptors to the peer of an AF_UNIX socket, with
+  ///             one sendmsg(2) carrying a SCM_RIGHTS control message.
+  /// \param[in]  fds the file descriptors to pass, at most max_passed_fds of them, or the operation
+  ///             fails with std::errc::invalid_argument. The peer receives duplicates, so they could
+  ///             be closed once the operation finishes.
+  /// \param[in]  args buffers, with the same requirements as in send(Args&&... args). A stream socket
+  ///             must send at least one byte along with the file descriptors.
+  /// \note       After the operation is co_await'ed and then finish, it will return the bytes transferred.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_fds(std::span<const int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<>
+      >;
+    return async_send_fds<policy, F>
+      {*static_cast<F*>(this), fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_fds(fds, args...), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_fds(std::error_code& error, std::span<const int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<std::error_code>
+      >;
+    return async_send_fds<policy, F>
+      {*static_cast<F*>(this), error, fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_fds(fds, args...), but imposes a timout on the operation.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_fds(Duration&& duration, std::span<const int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration>
+      >;
+    return async_send_fds<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_fds(fds, args...), but imposes a timout on the operation and reports
+  ///        error by std::error_code
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_fds(Duration&& duration, std::error_code& error,
+                          std::span<const int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration, std::error_code>
+      >;
+    return async_send_fds<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), error, fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief      create an awaiter for receiving data and the file descriptors passed along with it
+  ///             with one recvmsg(2).
+  /// \param[out] fds the received file descriptors are written here. They are opened with O_CLOEXEC
+  ///             and owned by the caller. If more are passed than fds could hold, all of them are
+  ///             closed and the operation fails with std::errc::message_size. The data is received
+  ///             nevertheless, its size is still returned if the error is reported by error code.
+  /// \param[out] args buffers, with the same requirements as in recv(Args&&... args).
+  /// \note       After the operation is co_await'ed and then finish, it will return a received_fds.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_fds(std::span<int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<>
+      >;
+    return async_recv_fds<policy, F>
+      {*static_cast<F*>(this), fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_fds(fds, args...), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_fds(std::error_code& error, std::span<int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<std::error_code>
+      >;
+    return async_recv_fds<policy, F>
+      {*static_cast<F*>(this), error, fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_fds(fds, args...), but imposes a timout on the operation.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_fds(Duration&& duration, std::span<int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration>
+      >;
+    return async_recv_fds<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), fds, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_fds(fds, args...), but imposes a timout on the operation and reports
+  ///        error by std::error_code
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_fds(Duration&& duration, std::error_code& error,
+                          std::span<int> fds, Args&&... args) noexcept
+  {
+    using policy =
+      async_recvmsg_policy
+      <
+        true,
+        decltype(buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration, std::error_code>
+      >;
+    return async_recv_fds<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), error, fds, std::forward<Args>(args)...};
+  }
+};
+
+}
+
+#endif //XYNET_SOCKET_FD_PASSING_H
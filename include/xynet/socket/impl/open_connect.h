@@ -0,0 +1,316 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_OPEN_CONNECT_H
+#define XYNET_SOCKET_OPEN_CONNECT_H
+
+#include <array>
+#include <initializer_list>
+#include <cerrno>
+#include <optional>
+#include <unistd.h>
+#include <liburing.h>
+
+#include "xynet/detail/async_operation.h"
+#include "xynet/socket/impl/address.h"
+#include "xynet/socket/impl/setsockopt.h"
+
+namespace xynet
+{
+
+/// \brief create a socket, apply the connection part of a socket_profile and connect it,
+///        without a system call on the io_service thread.
+///
+///        With a free direct descriptor on the io_service, the steps are submitted as one
+///        chain of hard linked sqes on a direct descriptor: IORING_OP_SOCKET, a
+///        SOCKET_URING_OP_SETSOCKOPT per option, IORING_OP_CONNECT, IORING_OP_FIXED_FD_INSTALL
+///        to get a regular fd for the rest of the operations, and a close of the direct
+///        descriptor. Otherwise, or on a kernel without IORING_OP_FIXED_FD_INSTALL(Linux 6.8),
+///        the socket is created with IORING_OP_SOCKET, the options are set by setsockopt(2)
+///        and then it is connected.
+///
+///        An option the kernel rejects does not fail the operation, the same as
+///        accept(peer, profile).
+template<typename Policy, typename F>
+class async_open_connect : public async_operation<Policy, async_open_connect<Policy, F>>
+{
+  using base_type = async_operation<Policy, async_open_connect<Policy, F>>;
+
+  struct socket_option
+  {
+    int level;
+    int name;
+    int value;
+  };
+
+  // every sqe of the chain that has a result to look at completes into one of these.
+  // Several cqes of the chain are usually reaped in the same batch, so they can not
+  // share the result of the operation itself.
+  struct chain_step : public async_operation_base
+  {
+    // bound when the operation is awaited, as the awaiter may be moved before that.
+    void bind(async_open_connect* op) noexcept
+    {
+      async_operation_base::set_callback(&async_open_connect::on_step_completed);
+      async_operation_base::set_error_ptr(&m_error);
+      mp_op = op;
+    }
+
+    async_open_connect* mp_op = nullptr;
+    std::error_code m_error;
+  };
+
+public:
+  template<typename... Args>
+  async_open_connect(F& socket, const socket_address& address, const socket_profile& profile,
+                     Args&&... args) noexcept
+  : base_type{&async_open_connect::on_fallback_completed, std::forward<Args>(args)...}
+  , m_socket{socket}
+  , m_addr{*address.as_sockaddr_in()}
+  , m_profile{profile}
+  {}
+
+  void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+  {
+    async_operation_base::set_awaiting_coroutine(awaiting_coroutine);
+    async_operation_base::get_error_code().clear();
+
+    // we have to close the open socket first
+    if(auto fd = m_socket.get(); fd != -1)
+    {
+      ::close(fd);
+      m_socket.set(-1);
+    }
+
+    detail::for_each_connection_option(m_profile, [this](int level, int name, int value)
+    {
+      m_options[m_option_count++] = socket_option{level, name, value};
+      return true;
+    });
+
+    if(m_slot = async_operation_base::get_service()->allocate_direct_descriptor(); m_slot)
+    {
+      for(auto* step : {&m_socket_step, &m_connect_step, &m_install_step, &m_close_step})
+      {
+        step->bind(this);
+      }
+      submit_chain();
+    }
+    else
+    {
+      submit_socket();
+    }
+  }
+
+private:
+  friend base_type;
+
+  enum class fallback_state
+  {
+    socket,
+    connect
+  };
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  void submit_chain() noexcept
+  {
+    auto* service = async_operation_base::get_service();
+    auto  slot    = static_cast<int>(*m_slot);
+
+    service->try_submit_io([this](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_socket_direct(sqe, F::socket_domain, F::socket_type, F::socket_protocol, *m_slot, 0);
+      sqe->flags |= IOSQE_IO_HARDLINK;
+      sqe->user_data = reinterpret_cast<uintptr_t>(&m_socket_step);
+    });
+
+    for(auto i = std::size_t{}; i < m_option_count; ++i)
+    {
+      service->try_submit_io([option = &m_options[i], slot](::io_uring_sqe* sqe)
+      {
+        ::io_uring_prep_cmd_sock(sqe, SOCKET_URING_OP_SETSOCKOPT, slot,
+                                 option->level, option->name, &option->value, sizeof(option->value));
+        sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+        // the result of an option is not waited for.
+        sqe->user_data = 0;
+      });
+    }
+
+    service->try_submit_io([this, slot](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_connect(sqe, slot, reinterpret_cast<::sockaddr*>(&m_addr), sizeof(m_addr));
+      sqe->flags |= IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+      sqe->user_data = reinterpret_cast<uintptr_t>(&m_connect_step);
+    });
+
+    service->try_submit_io([this, slot](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_fixed_fd_install(sqe, slot, 0);
+      sqe->flags |= IOSQE_IO_HARDLINK;
+      sqe->user_data = reinterpret_cast<uintptr_t>(&m_install_step);
+    });
+
+    // hard linked, so the slot is closed whatever happened before.
+    service->try_submit_io([this](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_close_direct(sqe, *m_slot);
+      sqe->user_data = reinterpret_cast<uintptr_t>(&m_close_step);
+    });
+  }
+
+  static void on_step_completed(async_operation_base* base) noexcept
+  {
+    auto* op = static_cast<chain_step*>(base)->mp_op;
+    if(++op->m_steps_completed == 4)
+    {
+      op->on_chain_completed();
+    }
+  }
+
+  void on_chain_completed() noexcept
+  {
+    async_operation_base::get_service()->release_direct_descriptor(*m_slot);
+    m_slot.reset();
+
+    // an opcode the kernel does not know fails the whole chain before any of it runs.
+    if(m_install_step.get_res() == -EINVAL && m_socket_step.get_res() == -ECANCELED)
+    {
+      submit_socket();
+      return;
+    }
+
+    auto fd = m_install_step.get_res();
+    auto& error = async_operation_base::get_error_code();
+    if(m_socket_step.m_error)
+    {
+      error = m_socket_step.m_error;
+    }
+    else if(m_connect_step.m_error)
+    {
+      error = m_connect_step.m_error;
+    }
+    else if(m_install_step.m_error)
+    {
+      error = m_install_step.m_error;
+    }
+
+    if(error)
+    {
+      if(fd >= 0)
+      {
+        ::close(fd);
+      }
+    }
+    else
+    {
+      m_socket.set(fd);
+    }
+    async_operation_base::get_awaiting_coroutine().resume();
+  }
+
+  void submit_socket() noexcept
+  {
+    m_state = fallback_state::socket;
+    async_operation_base::get_service()->try_submit_io([this](::io_uring_sqe* sqe)
+    {
+      ::io_uring_prep_socket(sqe, F::socket_domain, F::socket_type, F::socket_protocol, 0);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    });
+  }
+
+  static void on_fallback_completed(async_operation_base* base) noexcept
+  {
+    auto* op = static_cast<async_open_connect*>(base);
+    op->update_fallback();
+  }
+
+  void update_fallback() noexcept
+  {
+    auto& error = async_operation_base::get_error_code();
+    if(!error && m_state == fallback_state::socket)
+    {
+      m_socket.set(async_operation_base::get_res());
+      for(auto i = std::size_t{}; i < m_option_count; ++i)
+      {
+        auto& option = m_options[i];
+        ::setsockopt(m_socket.get(), option.level, option.name, &option.value, sizeof(option.value));
+      }
+
+      m_state = fallback_state::connect;
+      async_operation_base::get_service()->try_submit_io([this](::io_uring_sqe* sqe)
+      {
+        ::io_uring_prep_connect(sqe, m_socket.get(), reinterpret_cast<::sockaddr*>(&m_addr), sizeof(m_addr));
+        sqe->user_data = reinterpret_cast<uintptr_t>(this);
+      });
+      return;
+    }
+
+    if(error && m_socket.get() != -1)
+    {
+      ::close(m_socket.get());
+      m_socket.set(-1);
+    }
+    async_operation_base::get_awaiting_coroutine().resume();
+  }
+
+  decltype(auto) get_result()
+  noexcept (Policy::error_code_type::value)
+  {
+    if (!async_operation_base::get_error_code())[[likely]]
+    {
+      if constexpr(file_descriptor_has_module_v<std::decay_t<F>, xynet::template address>)
+      {
+        m_socket.set_peer_address(socket_address{m_addr});
+      }
+    }
+    else[[unlikely]]
+    {
+      if constexpr (!Policy::error_code_type::value)
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+  }
+
+  F& m_socket;
+  ::sockaddr_in m_addr;
+  socket_profile m_profile;
+  std::array<socket_option, detail::max_connection_options> m_options{};
+  std::size_t m_option_count = 0;
+
+  std::optional<unsigned> m_slot;
+  chain_step m_socket_step;
+  chain_step m_connect_step;
+  chain_step m_install_step;
+  chain_step m_close_step;
+  unsigned int m_steps_completed = 0;
+
+  fallback_state m_state = fallback_state::socket;
+};
+
+template<typename F>
+struct operation_open_connect
+{
+  /// \brief      Create an awaiter to create the socket, apply the connection part of profile
+  ///             and connect it to address, as one chain of io_uring operations. See
+  ///             async_open_connect. The open socket, if any, is closed first.
+  /// \param      args  nothing to report error by exception, or an lvalue reference of a
+  ///                   std::error_code. On error the socket is left closed.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) open_connect(const socket_address& address, const socket_profile& profile,
+                              Args&... args) noexcept
+  {
+    using policy_type = typename async_operation_traits<std::decay_t<Args>...>::policy_type;
+    return async_open_connect<policy_type, F>{*static_cast<F*>(this), address, profile, args...};
+  }
+};
+
+}
+
+#endif //XYNET_SOCKET_OPEN_CONNECT_H
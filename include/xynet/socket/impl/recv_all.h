@@ -9,14 +9,17 @@
 #include "xynet/buffer.h"
 #include "xynet/detail/async_operation.h"
 #include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/socket/impl/transport_stats.h"
+#include "xynet/socket/impl/timestamping.h"
 
 namespace xynet
 {
 
-template<bool enable_recv_some, typename BufferType, typename BasePolicy>
+template<bool enable_recv_some, typename BufferType, typename BasePolicy, bool enable_timestamp = false>
 struct async_recvmsg_policy : public BasePolicy::policy_type
 {
   using recv_some_type = std::conditional_t<enable_recv_some, std::true_type, std::false_type>;
+  using timestamp_type = std::conditional_t<enable_timestamp, std::true_type, std::false_type>;
   using buffer_type = BufferType;
 };
 
@@ -70,11 +73,12 @@ private:
   static void on_recv_completed(async_operation_base *base) noexcept
   {
     auto *op = static_cast<async_recvmsg*>(base);
+    op->m_timestamp.parse(op->m_msghdr);
     if constexpr (Policy::recv_some_type::value)
     {
       auto ret = base->get_res();
       op->m_bytes_transferred = ret >= 0 ? ret : 0;
-      async_operation_base::on_operation_completed(base);
+      op->complete();
     }
     else
     {
@@ -87,6 +91,11 @@ private:
   {
     return [this](::io_uring_sqe* sqe)
     {
+      // the iovecs may live in the awaiter, which may have been moved since it was created.
+      std::tie(m_msghdr.msg_iov,
+                m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
+      // the kernel shrinks msg_controllen to what it has written.
+      m_timestamp.prepare(m_msghdr);
       ::io_uring_prep_recvmsg(sqe,
                               m_socket.get(),
                               &m_msghdr,
@@ -101,7 +110,7 @@ private:
     if(async_operation_base::get_error_code() 
       || async_operation_base::get_res() == 0)
     {
-      async_operation_base::get_awaiting_coroutine().resume();
+      complete();
     }
     else
     {
@@ -111,7 +120,7 @@ private:
                 m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
       if(m_msghdr.msg_iov == nullptr)
       {
-        async_operation_base::get_awaiting_coroutine().resume();
+        complete();
       }
       else
       {
@@ -120,7 +129,13 @@ private:
     }
   }
 
-  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  void complete() noexcept
+  {
+    detail::count_received(m_socket, m_bytes_transferred, async_operation_base::get_service());
+    async_operation_base::get_awaiting_coroutine().resume();
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value)
   {
     if(async_operation_base::get_res() == 0)
     {
@@ -136,7 +151,14 @@ private:
       }
     }
 
-    return m_bytes_transferred;
+    if constexpr (Policy::timestamp_type::value)
+    {
+      return timestamped_recv{static_cast<std::size_t>(m_bytes_transferred), m_timestamp.m_time};
+    }
+    else
+    {
+      return static_cast<std::size_t>(m_bytes_transferred);
+    }
   }
   
   friend async_operation<Policy, async_recvmsg<Policy, F>>;
@@ -144,6 +166,8 @@ private:
   Policy::buffer_type m_buffers;
   int m_bytes_transferred;
   ::msghdr m_msghdr;
+  [[no_unique_address]]
+  detail::recv_timestamp_storage<Policy::timestamp_type::value> m_timestamp;
 };
 
 template<typename F>
@@ -263,6 +287,31 @@ struct operation_recv
     return async_recvmsg<policy, F>{*static_cast<F*>(this), std::forward<Duration>(duration), error, std::forward<Args>(args)...};
   }
 
+  /// \brief same as recv_some(Args&&... args), but also return the time the kernel received the data,
+  ///        parsed from the SCM_TIMESTAMPING control message. The socket needs the operation_timestamping
+  ///        module and enable_timestamping() with rx enabled, otherwise kernel_time is empty.
+  ///        After the operation is co_await'ed, it returns a timestamped_recv.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_some_timestamped(Args&&... args) noexcept
+  {
+    using policy = async_recvmsg_policy<true, decltype(buffer_sequence{std::forward<Args>(args)...}), 
+      async_operation_traits<>, true>;
+    return async_recvmsg<policy, F>{*static_cast<F*>(this), std::forward<Args>(args)...};
+  }
+
+  /// \brief same as recv_some_timestamped(Args&&... args), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) recv_some_timestamped(std::error_code& error, Args&&... args) noexcept
+  {
+    using policy = async_recvmsg_policy<true, decltype(buffer_sequence{std::forward<Args>(args)...}), 
+      async_operation_traits<std::error_code>, true>;
+    return async_recvmsg<policy, F>{*static_cast<F*>(this), error, std::forward<Args>(args)...};
+  }
+
 };
 
 }
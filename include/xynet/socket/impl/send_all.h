@@ -10,6 +10,7 @@
 #include "xynet/buffer.h"
 #include "xynet/detail/async_operation.h"
 #include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/socket/impl/transport_stats.h"
 
 namespace xynet
 {
@@ -79,6 +80,9 @@ struct async_sendmsg : public async_operation<Policy, async_sendmsg<Policy, F>>
   {
     return [this](::io_uring_sqe* sqe)
     {
+      // the iovecs may live in the awaiter, which may have been moved since it was created.
+      std::tie(m_msghdr.msg_iov,
+                m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
       ::io_uring_prep_sendmsg(sqe,
                               m_socket.get(),
                               &m_msghdr,
@@ -93,7 +97,7 @@ struct async_sendmsg : public async_operation<Policy, async_sendmsg<Policy, F>>
     if(async_operation_base::get_error_code() 
      ||async_operation_base::get_res() == 0 )
     {
-      async_operation_base::get_awaiting_coroutine().resume();
+      complete();
     }
     else
     {
@@ -103,7 +107,7 @@ struct async_sendmsg : public async_operation<Policy, async_sendmsg<Policy, F>>
                 m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
       if(m_msghdr.msg_iov == nullptr)
       {
-        async_operation_base::get_awaiting_coroutine().resume();
+        complete();
       }
       else
       {
@@ -112,6 +116,12 @@ struct async_sendmsg : public async_operation<Policy, async_sendmsg<Policy, F>>
     }
   }
 
+  void complete() noexcept
+  {
+    detail::count_sent(m_socket, m_bytes_transferred, async_operation_base::get_service());
+    async_operation_base::get_awaiting_coroutine().resume();
+  }
+
   auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
   {
     if constexpr (Policy::error_code_type::value)
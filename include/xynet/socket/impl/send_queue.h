@@ -0,0 +1,440 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_SEND_QUEUE_H
+#define XYNET_SOCKET_SEND_QUEUE_H
+
+#include <deque>
+#include <memory>
+#include <span>
+#include <variant>
+#include <vector>
+#include <coroutine>
+#include <climits>
+#include <netinet/tcp.h>
+#include "xynet/shared_buffer.h"
+#include "xynet/detail/async_operation.h"
+#include "xynet/socket/impl/transport_stats.h"
+#include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/detail/sync_operation.h"
+
+namespace xynet
+{
+
+namespace detail
+{
+
+struct send_queue_entry
+{
+  // keeps the buffer alive until it is fully sent. an empty std::shared_ptr for
+  // buffers that are owned by the caller.
+  std::variant<std::shared_ptr<const void>, shared_buffer> m_owner;
+  // the part of the buffer that has not been sent yet.
+  ::iovec m_iov;
+};
+
+}
+
+template<typename Policy, typename F>
+struct async_flush : public async_operation<Policy, async_flush<Policy, F>>
+{
+  async_flush(F& socket, int flags) noexcept
+  :async_operation<Policy, async_flush<Policy, F>>
+    {&async_flush::on_send_completed}
+  ,m_socket{socket}
+  ,m_flags{flags}
+  {}
+
+  async_flush(F& socket, std::error_code& error, int flags) noexcept
+  :async_operation<Policy, async_flush<Policy, F>>
+    {&async_flush::on_send_completed, error}
+  ,m_socket{socket}
+  ,m_flags{flags}
+  {}
+
+  template<DurationType Duration>
+  async_flush(F& socket, Duration&& duration, int flags) noexcept
+  :async_operation<Policy, async_flush<Policy, F>>
+    {&async_flush::on_send_completed, std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_flags{flags}
+  {}
+
+  template<DurationType Duration>
+  async_flush(F& socket, Duration&& duration, std::error_code& error, int flags) noexcept
+  :async_operation<Policy, async_flush<Policy, F>>
+    {&async_flush::on_send_completed, std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_flags{flags}
+  {}
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  static void on_send_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_flush*>(base);
+    op->update_result();
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      std::tie(m_msghdr.msg_iov, m_msghdr.msg_iovlen) = m_socket.prepare_send_queue();
+      ::io_uring_prep_sendmsg(sqe, m_socket.get(), &m_msghdr, MSG_NOSIGNAL | m_flags);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  void update_result()
+  {
+    auto done = true;
+
+    if(!async_operation_base::get_error_code())
+    {
+      auto res = async_operation_base::get_res();
+      m_bytes_transferred += res;
+      m_socket.consume_send_queue(res);
+      // buffers enqueued while the sendmsg was in flight are sent by the same flush.
+      if(res > 0 && !m_socket.send_queue_empty())
+      {
+        done = false;
+        async_operation<Policy, async_flush<Policy, F>>::submit();
+      }
+    }
+
+    if(done)
+    {
+      detail::count_sent(m_socket, m_bytes_transferred, async_operation_base::get_service());
+      async_operation_base::get_awaiting_coroutine().resume();
+    }
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (Policy::error_code_type::value)
+    {
+      return m_bytes_transferred;
+    }
+    else
+    {
+      if(!async_operation_base::get_error_code())[[likely]]
+      {
+        return m_bytes_transferred;
+      }
+      else[[unlikely]]
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+  }
+
+private:
+  F& m_socket;
+  int m_flags;
+  std::size_t m_bytes_transferred = 0;
+  ::msghdr m_msghdr = ::msghdr{};
+};
+
+template<typename F>
+class operation_send_queue
+{
+public:
+  inline static constexpr std::size_t default_low_watermark  = 32 * 1024;
+  inline static constexpr std::size_t default_high_watermark = 64 * 1024;
+
+  /// \brief append a buffer to the send queue without taking the ownership.
+  /// \note  the buffer must stay alive and unchanged until it is sent by flush().
+  auto enqueue(std::span<const std::byte> buffer) -> void
+  {
+    push_send_queue(std::shared_ptr<const void>{}, buffer);
+  }
+
+  /// \brief append a buffer to the send queue. The send queue shares the ownership of
+  ///        the buffer with owner until the buffer is fully sent.
+  auto enqueue(std::shared_ptr<const void> owner, std::span<const std::byte> buffer) -> void
+  {
+    push_send_queue(std::move(owner), buffer);
+  }
+
+  /// \brief append a contiguous container, e.g. a std::shared_ptr<std::vector<std::byte>>, to the
+  ///        send queue. The send queue shares the ownership of the container until it is fully sent.
+  template<typename Container>
+  requires std::ranges::contiguous_range<Container>
+  auto enqueue(std::shared_ptr<Container> container) -> void
+  {
+    auto buffer = std::as_bytes(std::span{*container});
+    push_send_queue(std::move(container), buffer);
+  }
+
+  /// \brief append a shared_buffer to the send queue. The send queue holds a reference to the
+  ///        buffer until it is fully sent, a buffer of buffer_sharing::local does not cost an
+  ///        atomic operation.
+  auto enqueue(shared_buffer buffer) -> void
+  {
+    auto bytes = std::span<const std::byte>{buffer.data(), buffer.size()};
+    push_send_queue(std::move(buffer), bytes);
+  }
+
+  /// \brief the number of bytes enqueued but not sent yet.
+  [[nodiscard]]
+  auto send_queue_bytes() const noexcept -> std::size_t
+  {
+    return m_send_queue_bytes;
+  }
+
+  [[nodiscard]]
+  auto send_queue_empty() const noexcept -> bool
+  {
+    return !mp_send_queue || mp_send_queue->empty();
+  }
+
+  /// \brief drop all the buffers that are not sent yet and wake up the writer waiting on writable().
+  /// \note  must not be called while a flush() is in progress.
+  auto clear_send_queue() noexcept -> void
+  {
+    if(mp_send_queue)
+    {
+      mp_send_queue->clear();
+    }
+    m_send_queue_bytes = 0;
+    wake_writable_waiter();
+  }
+
+  /// \brief set the watermarks of the send queue. writable() suspends the writer once
+  ///        send_queue_bytes() reaches high, and resumes it after flush() has drained the
+  ///        queue down to low.
+  auto set_send_queue_watermarks(std::size_t low, std::size_t high) noexcept -> void
+  {
+    m_low_watermark  = low;
+    m_high_watermark = high < low ? low : high;
+  }
+
+  /// \brief create an awaiter that completes once the send queue is below the high watermark.
+  ///        At most one coroutine could wait on it at a time.
+  [[nodiscard]]
+  auto writable() noexcept
+  {
+    struct awaiter : public async_operation_base
+    {
+      awaiter(operation_send_queue& queue) noexcept
+      :async_operation_base{io_service::get_thread_io_service()}
+      ,m_queue{queue}
+      {}
+
+      bool await_ready() const noexcept
+      {
+        return m_queue.m_send_queue_bytes < m_queue.m_high_watermark;
+      }
+
+      void await_suspend(std::coroutine_handle<> awaiting_coroutine) noexcept
+      {
+        async_operation_base::set_awaiting_coroutine(awaiting_coroutine);
+        m_queue.mp_writable_waiter = this;
+      }
+
+      void await_resume() const noexcept {}
+
+      operation_send_queue& m_queue;
+    };
+    return awaiter{*this};
+  }
+
+  /// \brief create an awaiter that sends everything in the send queue. Each sendmsg(2) carries as many
+  ///        enqueued buffers as possible(up to IOV_MAX), so a burst of small buffers costs one system call.
+  /// \param[in] flags extra flags for sendmsg(2), e.g. MSG_MORE if the caller will enqueue the rest of a
+  ///                  response shortly.
+  /// \note  - Buffers enqueued while the flush is in progress are sent by the same flush.
+  ///        - There should be at most one flush in progress on a socket.
+  ///        - After the operation is co_await'ed and then finish, it will return the bytes transferred.
+  [[nodiscard]]
+  decltype(auto) flush(int flags = 0) noexcept
+  {
+    using policy = async_operation_traits<>::policy_type;
+    return async_flush<policy, F>{*static_cast<F*>(this), flags};
+  }
+
+  /// \brief same as flush(int flags), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  [[nodiscard]]
+  decltype(auto) flush(std::error_code& error, int flags = 0) noexcept
+  {
+    using policy = async_operation_traits<std::error_code>::policy_type;
+    return async_flush<policy, F>{*static_cast<F*>(this), error, flags};
+  }
+
+  /// \brief same as flush(int flags), but imposes a timout on each single sendmsg.
+  /// \param[in] duration If one single sendmsg does not finish within the given duration, the operation will be
+  ///                     canneled and an error_code (std::errc::operation_canceled) will be returned.
+  template<DurationType Duration>
+  [[nodiscard]]
+  decltype(auto) flush(Duration&& duration, int flags = 0) noexcept
+  {
+    using policy = async_operation_traits<Duration>::policy_type;
+    return async_flush<policy, F>{*static_cast<F*>(this), std::forward<Duration>(duration), flags};
+  }
+
+  /// \brief same as flush(int flags), but imposes a timout on each single sendmsg and reports
+  ///        error by std::error_code
+  template<DurationType Duration>
+  [[nodiscard]]
+  decltype(auto) flush(Duration&& duration, std::error_code& error, int flags = 0) noexcept
+  {
+    using policy = async_operation_traits<Duration, std::error_code>::policy_type;
+    return async_flush<policy, F>{*static_cast<F*>(this), std::forward<Duration>(duration), error, flags};
+  }
+
+  /// \brief set TCP_CORK, so that partial frames are held back until uncork(). report error by error_code.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto cork(std::error_code& error) noexcept -> void
+  {
+    set_cork(1, error);
+  }
+
+  /// \brief set TCP_CORK. report error by exception.
+  auto cork() -> void
+  {
+    auto error = std::error_code{};
+    cork(error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief clear TCP_CORK, the pending partial frame is sent immediately. report error by error_code.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto uncork(std::error_code& error) noexcept -> void
+  {
+    set_cork(0, error);
+  }
+
+  /// \brief clear TCP_CORK. report error by exception.
+  auto uncork() -> void
+  {
+    auto error = std::error_code{};
+    uncork(error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief used by async_flush. fill the iovecs for the next sendmsg(2) from the front of the queue.
+  auto prepare_send_queue() -> std::pair<::iovec*, std::size_t>
+  {
+    m_send_queue_iov.clear();
+    if(!mp_send_queue)
+    {
+      // nothing was ever enqueued, the sendmsg(2) sends nothing and the flush completes.
+      return {nullptr, 0};
+    }
+    for(const auto& entry : *mp_send_queue)
+    {
+      if(m_send_queue_iov.size() == IOV_MAX)
+      {
+        break;
+      }
+      m_send_queue_iov.push_back(entry.m_iov);
+    }
+    return {m_send_queue_iov.data(), m_send_queue_iov.size()};
+  }
+
+  /// \brief used by async_flush. drop the first len bytes of the queue, and wake up the writer
+  ///        waiting on writable() if the queue has been drained down to the low watermark.
+  auto consume_send_queue(std::size_t len) noexcept -> void
+  {
+    m_send_queue_bytes -= len;
+    while(len > 0 && !send_queue_empty())
+    {
+      auto& iov = mp_send_queue->front().m_iov;
+      if(len >= iov.iov_len)
+      {
+        len -= iov.iov_len;
+        mp_send_queue->pop_front();
+      }
+      else
+      {
+        iov.iov_base = static_cast<char *>(iov.iov_base) + len;
+        iov.iov_len  -= len;
+        len = 0;
+      }
+    }
+
+    if(m_send_queue_bytes <= m_low_watermark)
+    {
+      wake_writable_waiter();
+    }
+  }
+
+private:
+  // the writer is resumed by the io_service, not inside the completion of the flush or the
+  // caller of clear_send_queue().
+  auto wake_writable_waiter() noexcept -> void
+  {
+    auto* waiter = std::exchange(mp_writable_waiter, nullptr);
+    if(waiter == nullptr)
+    {
+      return;
+    }
+    if(auto* service = waiter->get_service(); service != nullptr)
+    {
+      service->schedule_local(waiter);
+    }
+    else
+    {
+      waiter->execute(waiter);
+    }
+  }
+
+  template<typename Owner>
+  auto push_send_queue(Owner owner, std::span<const std::byte> buffer) -> void
+  {
+    if(buffer.empty())
+    {
+      return;
+    }
+    // created by the first enqueue, as a std::deque allocates even when it is empty.
+    if(!mp_send_queue)
+    {
+      mp_send_queue = std::make_unique<std::deque<detail::send_queue_entry>>();
+    }
+    mp_send_queue->push_back(detail::send_queue_entry{
+      .m_owner = std::move(owner),
+      .m_iov   = ::iovec{
+        .iov_base = const_cast<void *>(static_cast<const void *>(buffer.data())),
+        .iov_len  = buffer.size_bytes()}});
+    m_send_queue_bytes += buffer.size_bytes();
+  }
+
+  auto set_cork(int optval, std::error_code& error) noexcept -> void
+  {
+    detail::sync_operation
+    (
+      [fd = static_cast<const F*>(this)->get(), &optval]()
+      {
+        return ::setsockopt(fd, IPPROTO_TCP, TCP_CORK, &optval, sizeof(optval));
+      },
+      []([[maybe_unused]]int ret){},
+      error
+    );
+  }
+
+  std::unique_ptr<std::deque<detail::send_queue_entry>> mp_send_queue;
+  std::vector<::iovec> m_send_queue_iov;
+  std::size_t m_send_queue_bytes = 0;
+  std::size_t m_low_watermark    = default_low_watermark;
+  std::size_t m_high_watermark   = default_high_watermark;
+  async_operation_base* mp_writable_waiter = nullptr;
+};
+
+}
+#endif //XYNET_SOCKET_SEND_QUEUE_H
@@ -0,0 +1,301 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_SEND_ZC_H
+#define XYNET_SOCKET_SEND_ZC_H
+
+#include <type_traits>
+#include <climits>
+#include "xynet/buffer.h"
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/file_descriptor_traits.h"
+#include "xynet/socket/impl/send_all.h"
+
+namespace xynet
+{
+
+/// sends smaller than this are copied into the socket buffer as sendmsg(2) does.
+/// Pinning the user pages and waiting for the notification costs more than
+/// copying a few kilobytes.
+inline constexpr std::size_t send_zc_threshold = 16 * 1024;
+
+template<typename Policy, typename F>
+struct async_sendmsg_zc : public async_operation<Policy, async_sendmsg_zc<Policy, F>>
+{
+  template<typename... Args>
+  async_sendmsg_zc(F& socket, Args&&... args) noexcept
+  :async_operation<Policy, async_sendmsg_zc<Policy, F>>
+    {&async_sendmsg_zc::on_send_completed}
+  ,m_socket{socket}
+  ,m_buffers{static_cast<Args&&>(args)...}
+  ,m_msghdr{.msg_iov = m_buffers.get_iov_ptr(), .msg_iovlen = m_buffers.get_iov_cnt()}
+  ,m_bytes_remaining{remaining_bytes()}
+  {}
+
+  template<typename... Args>
+  async_sendmsg_zc(F& socket, std::error_code& error, Args&&... args) noexcept
+  :async_operation<Policy, async_sendmsg_zc<Policy, F>>
+    {&async_sendmsg_zc::on_send_completed, error}
+  ,m_socket{socket}
+  ,m_buffers{static_cast<Args&&>(args)...}
+  ,m_msghdr{.msg_iov = m_buffers.get_iov_ptr(), .msg_iovlen = m_buffers.get_iov_cnt()}
+  ,m_bytes_remaining{remaining_bytes()}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_sendmsg_zc(F& socket, Duration&& duration, Args&&... args) noexcept
+  :async_operation<Policy, async_sendmsg_zc<Policy, F>>
+    {&async_sendmsg_zc::on_send_completed, std::forward<Duration>(duration)}
+  ,m_socket{socket}
+  ,m_buffers{static_cast<Args&&>(args)...}
+  ,m_msghdr{.msg_iov = m_buffers.get_iov_ptr(), .msg_iovlen = m_buffers.get_iov_cnt()}
+  ,m_bytes_remaining{remaining_bytes()}
+  {}
+
+  template<DurationType Duration, typename... Args>
+  async_sendmsg_zc(F& socket, Duration&& duration, std::error_code& error, Args&&... args) noexcept
+  :async_operation<Policy, async_sendmsg_zc<Policy, F>>
+    {&async_sendmsg_zc::on_send_completed, std::forward<Duration>(duration), error}
+  ,m_socket{socket}
+  ,m_buffers{static_cast<Args&&>(args)...}
+  ,m_msghdr{.msg_iov = m_buffers.get_iov_ptr(), .msg_iovlen = m_buffers.get_iov_cnt()}
+  ,m_bytes_remaining{remaining_bytes()}
+  {}
+
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  static void on_send_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_sendmsg_zc*>(base);
+    op->update_result();
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
+    {
+      // the send cqe overwrites this, the notification cqe does not.
+      async_operation_base::set_res(pending_res);
+      m_zero_copy = m_zero_copy_supported && m_bytes_remaining >= send_zc_threshold;
+      // the iovecs may live in the awaiter, which may have been moved since it was created.
+      std::tie(m_msghdr.msg_iov,
+               m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
+
+      if(m_zero_copy)
+      {
+        ::io_uring_prep_sendmsg_zc(sqe, m_socket.get(), &m_msghdr, MSG_NOSIGNAL);
+      }
+      else
+      {
+        ::io_uring_prep_sendmsg(sqe, m_socket.get(), &m_msghdr, MSG_NOSIGNAL);
+      }
+
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  // A zero-copy send completes with two cqes: the result of the send, flagged with
+  // IORING_CQE_F_MORE, and later a notification once the kernel has released the
+  // pages. Both cqes may be reaped in the same batch, so this callback counts them
+  // and only resumes the awaiting coroutine on the last callback that is queued
+  // for this operation, after every notification has arrived.
+  void update_result()
+  {
+    ++m_callbacks;
+
+    if(async_operation_base::get_res() != pending_res)
+    {
+      auto res = async_operation_base::get_res();
+      async_operation_base::set_res(pending_res);
+      ++m_sends_completed;
+
+      if(async_operation_base::get_flags() & IORING_CQE_F_MORE)
+      {
+        ++m_notifications_expected;
+      }
+
+      if(auto& error = async_operation_base::get_error_code(); error)
+      {
+        if(m_zero_copy && m_bytes_transferred == 0
+        && (error == std::errc::operation_not_supported || error == std::errc::invalid_argument))
+        {
+          // the socket(or the kernel) does not support zero-copy, copy instead.
+          error.clear();
+          m_zero_copy_supported = false;
+          async_operation<Policy, async_sendmsg_zc<Policy, F>>::submit();
+        }
+        else
+        {
+          m_done = true;
+        }
+      }
+      else if(res == 0)
+      {
+        m_done = true;
+      }
+      else
+      {
+        m_bytes_transferred += res;
+        m_bytes_remaining   -= res;
+        m_buffers.commit(res);
+        std::tie(m_msghdr.msg_iov,
+                 m_msghdr.msg_iovlen) = m_buffers.get_iov_span();
+        if(m_msghdr.msg_iov == nullptr)
+        {
+          m_done = true;
+        }
+        else
+        {
+          // the already sent part may still be pinned, but the rest of the
+          // buffers can be queued right away.
+          async_operation<Policy, async_sendmsg_zc<Policy, F>>::submit();
+        }
+      }
+    }
+
+    auto notifications = async_operation_base::get_notifications();
+    if(m_done
+    && notifications == m_notifications_expected
+    && m_callbacks   == m_sends_completed + notifications)
+    {
+      detail::count_sent(m_socket, m_bytes_transferred, async_operation_base::get_service());
+      async_operation_base::get_awaiting_coroutine().resume();
+    }
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (Policy::error_code_type::value)
+    {
+      return m_bytes_transferred;
+    }
+    else
+    {
+      if(!async_operation_base::get_error_code())[[likely]]
+      {
+        return m_bytes_transferred;
+      }
+      else[[unlikely]]
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+  }
+
+private:
+  inline static constexpr int pending_res = INT_MIN;
+
+  auto remaining_bytes() noexcept -> std::size_t
+  {
+    auto [iov, cnt] = m_buffers.get_iov_span();
+    auto bytes = std::size_t{};
+    for(auto i = decltype(cnt){}; i < cnt; ++i)
+    {
+      bytes += iov[i].iov_len;
+    }
+    return bytes;
+  }
+
+  F& m_socket;
+  Policy::buffer_type m_buffers;
+  ::msghdr m_msghdr;
+  std::size_t m_bytes_remaining;
+  std::size_t m_bytes_transferred = 0;
+  unsigned int m_callbacks = 0;
+  unsigned int m_sends_completed = 0;
+  unsigned int m_notifications_expected = 0;
+  bool m_zero_copy = false;
+  bool m_zero_copy_supported = true;
+  bool m_done = false;
+};
+
+template<typename F>
+struct operation_send_zc
+{
+  /// \brief      create an awaiter for sending buffers with IORING_OP_SENDMSG_ZC, the zero-copy
+  ///             counterpart of send(Args&&... args). The pages of the buffers are handed to the
+  ///             NIC instead of being copied into the socket buffer.
+  /// \param[in]  args buffers, with the same requirements as in send(Args&&... args).
+  ///
+  /// \note       - The operation does not finish until the kernel has posted the notifications of all the
+  ///               zero-copy sends. Once co_await returns, the buffers could be modified or released.
+  ///             - If less than send_zc_threshold bytes remain to be sent, they are copied as sendmsg(2)
+  ///               does. So do all the sends on a socket which does not support zero-copy.
+  ///             - After the operation is co_await'ed and then finish, it will return the bytes transferred.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_zc(Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<>
+      >;
+    return async_sendmsg_zc<policy, F>
+      {*static_cast<F*>(this), std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_zc(Args&&... args), but use std::error_code to report error.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_zc(std::error_code& error, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<std::error_code>
+      >;
+    return async_sendmsg_zc<policy, F>
+      {*static_cast<F*>(this), error, std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_zc(Args&&... args), but imposes a timout on each single send operation.
+  /// \param[in] duration If one single send does not finish within the given duration, the operation will be
+  ///                     canneled and an error_code (std::errc::operation_canceled) will be returned.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_zc(Duration&& duration, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration>
+      >;
+    return async_sendmsg_zc<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), std::forward<Args>(args)...};
+  }
+
+  /// \brief same as send_zc(Args&&... args), but imposes a timout on each single send operation and reports
+  ///        error by std::error_code
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  /// \param[in] duration If one single send does not finish within the given duration, the operation will be
+  ///                     canneled and an error_code (std::errc::operation_canceled) will be returned.
+  template<DurationType Duration, typename... Args>
+  [[nodiscard]]
+  decltype(auto) send_zc(Duration&& duration, std::error_code& error, Args&&... args) noexcept
+  {
+    using policy =
+      async_sendmsg_policy
+      <
+        decltype(const_buffer_sequence{std::forward<Args>(args)...}),
+        async_operation_traits<Duration, std::error_code>
+      >;
+    return async_sendmsg_zc<policy, F>
+      {*static_cast<F*>(this), std::forward<Duration>(duration), error, std::forward<Args>(args)...};
+  }
+
+};
+
+}
+#endif //XYNET_SOCKET_SEND_ZC_H
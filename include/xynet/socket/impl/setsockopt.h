@@ -5,12 +5,116 @@
 #ifndef XYNET_SOCKET_SETSOCKOPT_H
 #define XYNET_SOCKET_SETSOCKOPT_H
 
+#include <chrono>
+#include <optional>
+#include <iterator>
+#include <netinet/tcp.h>
+#include <linux/filter.h>
 #include "xynet/detail/file_descriptor_traits.h"
 #include "xynet/detail/sync_operation.h"
 
 namespace xynet
 {
 
+struct keep_alive_settings
+{
+  std::chrono::seconds idle     = std::chrono::seconds{60};
+  std::chrono::seconds interval = std::chrono::seconds{10};
+  int                  count    = 6;
+};
+
+/// \brief a set of socket options. The listener part is applied to listening sockets before bind(2),
+///        and the connection part to the connected/accepted sockets.
+///        Options left as std::nullopt are not touched.
+struct socket_profile
+{
+  /* listener */
+  bool                                reuse_address = true;
+  bool                                reuse_port    = false;
+  std::optional<std::chrono::seconds> defer_accept;
+  std::optional<int>                  fast_open_queue;
+
+  /* connection */
+  std::optional<bool>                      no_delay;
+  std::optional<bool>                      quick_ack;
+  std::optional<int>                       receive_buffer_size;
+  std::optional<int>                       send_buffer_size;
+  std::optional<int>                       not_sent_low_watermark;
+  std::optional<keep_alive_settings>       keep_alive;
+  std::optional<std::chrono::microseconds> busy_poll;
+
+  /// \brief small request/response traffic: no Nagle, no delayed ACKs, and a small amount
+  ///        of unsent data in the socket buffer so that the latest message goes out first.
+  static socket_profile low_latency() noexcept
+  {
+    auto profile = socket_profile{};
+    profile.fast_open_queue        = 256;
+    profile.no_delay               = true;
+    profile.quick_ack              = true;
+    profile.not_sent_low_watermark = 16 * 1024;
+    return profile;
+  }
+
+  /// \brief large transfers: big socket buffers, and keep-alive to detect dead peers of
+  ///        long-lived connections.
+  static socket_profile bulk() noexcept
+  {
+    auto profile = socket_profile{};
+    profile.receive_buffer_size = 4 * 1024 * 1024;
+    profile.send_buffer_size    = 4 * 1024 * 1024;
+    profile.keep_alive          = keep_alive_settings{};
+    return profile;
+  }
+};
+
+namespace detail
+{
+
+/// \brief call func(level, name, value) for every integer option of the connection part of
+///        profile, in the order they are applied, until func returns false. Shared by the
+///        setsockopt(2) path and the io_uring one.
+template<typename Func>
+void for_each_connection_option(const socket_profile& profile, Func&& func)
+{
+  if(profile.no_delay && !func(IPPROTO_TCP, TCP_NODELAY, int{*profile.no_delay}))
+  {
+    return;
+  }
+  if(profile.quick_ack && !func(IPPROTO_TCP, TCP_QUICKACK, int{*profile.quick_ack}))
+  {
+    return;
+  }
+  if(profile.receive_buffer_size && !func(SOL_SOCKET, SO_RCVBUF, *profile.receive_buffer_size))
+  {
+    return;
+  }
+  if(profile.send_buffer_size && !func(SOL_SOCKET, SO_SNDBUF, *profile.send_buffer_size))
+  {
+    return;
+  }
+  if(profile.not_sent_low_watermark && !func(IPPROTO_TCP, TCP_NOTSENT_LOWAT, *profile.not_sent_low_watermark))
+  {
+    return;
+  }
+  if(profile.keep_alive
+  &&!(func(SOL_SOCKET,  SO_KEEPALIVE,  1)
+   && func(IPPROTO_TCP, TCP_KEEPIDLE,  static_cast<int>(profile.keep_alive->idle.count()))
+   && func(IPPROTO_TCP, TCP_KEEPINTVL, static_cast<int>(profile.keep_alive->interval.count()))
+   && func(IPPROTO_TCP, TCP_KEEPCNT,   profile.keep_alive->count)))
+  {
+    return;
+  }
+  if(profile.busy_poll)
+  {
+    func(SOL_SOCKET, SO_BUSY_POLL, static_cast<int>(profile.busy_poll->count()));
+  }
+}
+
+/// the maximum number of options for_each_connection_option visits.
+inline constexpr std::size_t max_connection_options = 10;
+
+}
+
 template <typename T>
 struct operation_set_options
 {
@@ -59,6 +163,318 @@ struct operation_set_options
     int optval = 1;
     setsockopt(SOL_SOCKET, SO_REUSEADDR, &optval, sizeof(optval));
   }
+
+  /// \brief set the socket option SO_REUSEPORT, so that several sockets could listen on the same port
+  ///        and the kernel balances the connections between them. report error by error_code
+  auto reuse_port(std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_REUSEPORT>(1, error);
+  }
+
+  /// \brief set the socket option SO_REUSEPORT. report error by exception
+  auto reuse_port() -> void
+  {
+    set_int_option<SOL_SOCKET, SO_REUSEPORT>(1);
+  }
+
+  /// \brief set or clear TCP_NODELAY, which disables Nagle's algorithm. report error by error_code
+  auto no_delay(bool enable, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_NODELAY>(enable, error);
+  }
+
+  /// \brief set or clear TCP_NODELAY. report error by exception
+  auto no_delay(bool enable = true) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_NODELAY>(enable);
+  }
+
+  /// \brief set or clear TCP_QUICKACK, which sends ACKs immediately instead of delaying them.
+  ///        report error by error_code
+  /// \note  the kernel may clear it again later, set it after each recv if it must stay on.
+  auto quick_ack(bool enable, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_QUICKACK>(enable, error);
+  }
+
+  /// \brief set or clear TCP_QUICKACK. report error by exception
+  auto quick_ack(bool enable = true) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_QUICKACK>(enable);
+  }
+
+  /// \brief set SO_RCVBUF. The kernel doubles the value for its bookkeeping. report error by error_code
+  auto receive_buffer_size(int bytes, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_RCVBUF>(bytes, error);
+  }
+
+  /// \brief set SO_RCVBUF. report error by exception
+  auto receive_buffer_size(int bytes) -> void
+  {
+    set_int_option<SOL_SOCKET, SO_RCVBUF>(bytes);
+  }
+
+  /// \brief set SO_SNDBUF. The kernel doubles the value for its bookkeeping. report error by error_code
+  auto send_buffer_size(int bytes, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_SNDBUF>(bytes, error);
+  }
+
+  /// \brief set SO_SNDBUF. report error by exception
+  auto send_buffer_size(int bytes) -> void
+  {
+    set_int_option<SOL_SOCKET, SO_SNDBUF>(bytes);
+  }
+
+  /// \brief set or clear SO_KEEPALIVE. report error by error_code
+  auto keep_alive(bool enable, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_KEEPALIVE>(enable, error);
+  }
+
+  /// \brief set or clear SO_KEEPALIVE. report error by exception
+  auto keep_alive(bool enable = true) -> void
+  {
+    set_int_option<SOL_SOCKET, SO_KEEPALIVE>(enable);
+  }
+
+  /// \brief set SO_KEEPALIVE together with TCP_KEEPIDLE, TCP_KEEPINTVL and TCP_KEEPCNT.
+  ///        report error by error_code
+  auto keep_alive(const keep_alive_settings& settings, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_KEEPALIVE>(1, error);
+    if(!error)
+    {
+      set_int_option<IPPROTO_TCP, TCP_KEEPIDLE>(static_cast<int>(settings.idle.count()), error);
+    }
+    if(!error)
+    {
+      set_int_option<IPPROTO_TCP, TCP_KEEPINTVL>(static_cast<int>(settings.interval.count()), error);
+    }
+    if(!error)
+    {
+      set_int_option<IPPROTO_TCP, TCP_KEEPCNT>(settings.count, error);
+    }
+  }
+
+  /// \brief set SO_KEEPALIVE together with TCP_KEEPIDLE, TCP_KEEPINTVL and TCP_KEEPCNT.
+  ///        report error by exception
+  auto keep_alive(const keep_alive_settings& settings) -> void
+  {
+    auto error = std::error_code{};
+    keep_alive(settings, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief set TCP_DEFER_ACCEPT on a listening socket, so accept(2) only completes once the peer
+  ///        has sent data or the timeout has expired. report error by error_code
+  auto defer_accept(std::chrono::seconds timeout, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_DEFER_ACCEPT>(static_cast<int>(timeout.count()), error);
+  }
+
+  /// \brief set TCP_DEFER_ACCEPT. report error by exception
+  auto defer_accept(std::chrono::seconds timeout) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_DEFER_ACCEPT>(static_cast<int>(timeout.count()));
+  }
+
+  /// \brief enable TCP Fast Open on a listening socket. report error by error_code
+  /// \param[in] queue_length the maximum number of pending TFO requests.
+  auto fast_open(int queue_length, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_FASTOPEN>(queue_length, error);
+  }
+
+  /// \brief enable TCP Fast Open on a listening socket. report error by exception
+  auto fast_open(int queue_length) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_FASTOPEN>(queue_length);
+  }
+
+  /// \brief set or clear TCP_FASTOPEN_CONNECT on a client socket, so that the data of the first send
+  ///        after connect travels in the SYN if the client holds a TFO cookie. report error by error_code
+  auto fast_open_connect(bool enable, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_FASTOPEN_CONNECT>(enable, error);
+  }
+
+  /// \brief set or clear TCP_FASTOPEN_CONNECT. report error by exception
+  auto fast_open_connect(bool enable = true) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_FASTOPEN_CONNECT>(enable);
+  }
+
+  /// \brief set SO_BUSY_POLL, the time to busy poll the device queue on a blocking receive.
+  ///        report error by error_code
+  /// \note  raising it above net.core.busy_read requires CAP_NET_ADMIN.
+  auto busy_poll(std::chrono::microseconds duration, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_BUSY_POLL>(static_cast<int>(duration.count()), error);
+  }
+
+  /// \brief set SO_BUSY_POLL. report error by exception
+  auto busy_poll(std::chrono::microseconds duration) -> void
+  {
+    set_int_option<SOL_SOCKET, SO_BUSY_POLL>(static_cast<int>(duration.count()));
+  }
+
+  /// \brief set TCP_NOTSENT_LOWAT, the amount of unsent data above which the socket is not writable.
+  ///        report error by error_code
+  auto not_sent_low_watermark(int bytes, std::error_code& error) noexcept -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_NOTSENT_LOWAT>(bytes, error);
+  }
+
+  /// \brief set TCP_NOTSENT_LOWAT. report error by exception
+  auto not_sent_low_watermark(int bytes) -> void
+  {
+    set_int_option<IPPROTO_TCP, TCP_NOTSENT_LOWAT>(bytes);
+  }
+
+  /// \brief set SO_INCOMING_CPU, which steers the connections of a SO_REUSEPORT group to the listener
+  ///        bound to the cpu handling the packets. report error by error_code
+  auto incoming_cpu(int cpu, std::error_code& error) noexcept -> void
+  {
+    set_int_option<SOL_SOCKET, SO_INCOMING_CPU>(cpu, error);
+  }
+
+  /// \brief set SO_INCOMING_CPU. report error by exception
+  auto incoming_cpu(int cpu) -> void
+  {
+    set_int_option<SOL_SOCKET, SO_INCOMING_CPU>(cpu);
+  }
+
+  /// \brief attach a SO_ATTACH_REUSEPORT_CBPF program to the SO_REUSEPORT group of the socket that
+  ///        hands a connection to the listener at index cpu % listeners, the cpu being the one that
+  ///        received the packet. The index of a listener is its position in the group, i.e. the
+  ///        order in which the listeners were bound. With listener i run by an io_service thread
+  ///        pinned to cpu i, the softirq, the socket and the ring of a connection stay on one core.
+  ///        Call it after bind(2) on any one listener of the group. report error by error_code
+  auto reuse_port_cpu_steering(unsigned listeners, std::error_code& error) noexcept -> void
+  {
+    // A = the receiving cpu; A %= listeners; return A.
+    ::sock_filter code[] =
+    {
+      {BPF_LD  | BPF_W   | BPF_ABS, 0, 0, static_cast<__u32>(SKF_AD_OFF + SKF_AD_CPU)},
+      {BPF_ALU | BPF_MOD | BPF_K,   0, 0, listeners},
+      {BPF_RET | BPF_A,             0, 0, 0},
+    };
+    auto program = ::sock_fprog{.len = std::size(code), .filter = code};
+    setsockopt(SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &program, sizeof(program), error);
+  }
+
+  /// \brief same as reuse_port_cpu_steering(listeners, error), but report error by exception
+  auto reuse_port_cpu_steering(unsigned listeners) -> void
+  {
+    auto error = std::error_code{};
+    reuse_port_cpu_steering(listeners, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief apply the listener part of a socket_profile. Call it before bind(2). report error by error_code
+  auto apply_listener_profile(const socket_profile& profile, std::error_code& error) noexcept -> void
+  {
+    error.clear();
+    if(profile.reuse_address && !error)
+    {
+      reuse_address(error);
+    }
+    if(profile.reuse_port && !error)
+    {
+      reuse_port(error);
+    }
+    if(profile.defer_accept && !error)
+    {
+      defer_accept(*profile.defer_accept, error);
+    }
+    if(profile.fast_open_queue && !error)
+    {
+      fast_open(*profile.fast_open_queue, error);
+    }
+    // the connection options are inherited by the accepted sockets, see apply_accepted_profile().
+    if(!error)
+    {
+      apply_connection_profile(profile, error);
+    }
+  }
+
+  /// \brief apply the listener part of a socket_profile. report error by exception
+  auto apply_listener_profile(const socket_profile& profile) -> void
+  {
+    auto error = std::error_code{};
+    apply_listener_profile(profile, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief apply the part of a socket_profile that an accepted socket does not inherit from its
+  ///        listener, to a socket accepted from a listener set up by apply_listener_profile(profile).
+  ///        That is TCP_QUICKACK only, which the kernel clears as the connection goes on, the other
+  ///        connection options are copied from the listener. report error by error_code
+  auto apply_accepted_profile(const socket_profile& profile, std::error_code& error) noexcept -> void
+  {
+    error.clear();
+    if(profile.quick_ack)
+    {
+      quick_ack(*profile.quick_ack, error);
+    }
+  }
+
+  /// \brief same as apply_accepted_profile(profile, error), but report error by exception
+  auto apply_accepted_profile(const socket_profile& profile) -> void
+  {
+    auto error = std::error_code{};
+    apply_accepted_profile(profile, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief apply the connection part of a socket_profile. report error by error_code
+  auto apply_connection_profile(const socket_profile& profile, std::error_code& error) noexcept -> void
+  {
+    error.clear();
+    detail::for_each_connection_option(profile, [this, &error](int level, int name, int value)
+    {
+      setsockopt(level, name, &value, sizeof(value), error);
+      return !error;
+    });
+  }
+
+  /// \brief apply the connection part of a socket_profile. report error by exception
+  auto apply_connection_profile(const socket_profile& profile) -> void
+  {
+    auto error = std::error_code{};
+    apply_connection_profile(profile, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+private:
+  template<int Level, int Name>
+  auto set_int_option(int optval, std::error_code& error) noexcept -> void
+  {
+    setsockopt(Level, Name, &optval, sizeof(optval), error);
+  }
+
+  template<int Level, int Name>
+  auto set_int_option(int optval) -> void
+  {
+    setsockopt(Level, Name, &optval, sizeof(optval));
+  }
 };
 
 }
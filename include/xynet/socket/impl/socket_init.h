@@ -10,14 +10,73 @@
 
 #include "xynet/detail/file_descriptor_traits.h"
 #include "xynet/detail/sync_operation.h"
+#include "xynet/detail/async_operation.h"
 
 namespace xynet
 {
 
-template<typename F>
-struct socket_init
+namespace detail
+{
+
+template<typename Policy, typename F, int Domain, int Type, int Protocol>
+class async_socket_init : public async_operation<Policy, async_socket_init<Policy, F, Domain, Type, Protocol>>
+{
+public:
+  template<typename... Args>
+  async_socket_init(F& socket, Args&&... args) noexcept
+  : async_operation<Policy, async_socket_init<Policy, F, Domain, Type, Protocol>>{std::forward<Args>(args)...}
+  , m_socket{socket}
+  {}
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe *sqe)
+    {
+      // we have to close the open socket first
+      if(auto fd = m_socket.get(); fd != -1)
+      {
+        ::close(fd);
+        m_socket.set(-1);
+      }
+
+      ::io_uring_prep_socket(sqe, Domain, Type, Protocol, 0);
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  decltype(auto) get_result()
+  noexcept (Policy::error_code_type::value)
+  {
+    if (!async_operation_base::get_error_code())[[likely]]
+    {
+      m_socket.set(async_operation_base::get_res());
+    }
+    else[[unlikely]]
+    {
+      if constexpr (!Policy::error_code_type::value)
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+  }
+
+  friend async_operation<Policy, async_socket_init<Policy, F, Domain, Type, Protocol>>;
+  F& m_socket;
+};
+
+template<typename F, int Domain, int Type, int Protocol>
+struct socket_init_base
 {
-  /// \brief initialize the socket with IPv4 & TCP. That is, call ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP)
+  static constexpr int socket_domain   = Domain;
+  static constexpr int socket_type     = Type;
+  static constexpr int socket_protocol = Protocol;
+
+  /// \brief initialize the socket. That is, call ::socket(Domain, Type, Protocol)
   ///         and set the fd of file_descriptor.
   /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
   ///             will be cleared.
@@ -33,7 +92,7 @@ struct socket_init
     (
       []()
       {
-        return ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+        return ::socket(Domain, Type, Protocol);
       }, 
       [file = static_cast<F*>(this)](int fd)
       {
@@ -43,7 +102,7 @@ struct socket_init
     );
   }
 
-  /// \brief initialize the socket with IPv4 & TCP. That is, call ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP)
+  /// \brief initialize the socket. That is, call ::socket(Domain, Type, Protocol)
   ///         and set the fd of file_descriptor. Report error by exception.
   auto init() -> void
   {
@@ -55,10 +114,43 @@ struct socket_init
     }
   }
 
+  /// \brief Create an awaiter to initialize the socket with IORING_OP_SOCKET, so the
+  ///        ::socket() call does not block the io_service thread. Requires Linux 5.19.
+  /// \param args  nothing to report error by exception, or an lvalue reference of a
+  ///              std::error_code.
+  template<typename... Args>
+  [[nodiscard]]
+  decltype(auto) async_init(Args&... args) noexcept
+  {
+    using policy_type = typename async_operation_traits<std::decay_t<Args>...>::policy_type;
+    return async_socket_init<policy_type, F, Domain, Type, Protocol>{*static_cast<F*>(this), args...};
+  }
 };
 
 }
 
+/// \brief initialize the socket with IPv4 & TCP. That is, call ::socket(AF_INET, SOCK_STREAM, IPPROTO_IP)
+template<typename F>
+struct socket_init : public detail::socket_init_base<F, AF_INET, SOCK_STREAM, IPPROTO_IP>
+{};
+
+/// \brief initialize the socket with IPv4 & UDP. That is, call ::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP)
+template<typename F>
+struct udp_socket_init : public detail::socket_init_base<F, AF_INET, SOCK_DGRAM, IPPROTO_UDP>
+{};
+
+/// \brief initialize the socket as an AF_UNIX stream socket. That is, call ::socket(AF_UNIX, SOCK_STREAM, 0)
+template<typename F>
+struct unix_stream_socket_init : public detail::socket_init_base<F, AF_UNIX, SOCK_STREAM, 0>
+{};
+
+/// \brief initialize the socket as an AF_UNIX datagram socket. That is, call ::socket(AF_UNIX, SOCK_DGRAM, 0)
+template<typename F>
+struct unix_datagram_socket_init : public detail::socket_init_base<F, AF_UNIX, SOCK_DGRAM, 0>
+{};
+
+}
+
 #endif //XYNET_TCP_SOCKET_H
 
 
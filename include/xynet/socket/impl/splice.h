@@ -5,101 +5,328 @@
 #ifndef XYNET_SOCKET_SPLICE_H
 #define XYNET_SOCKET_SPLICE_H
 
-#include "xynet/detail/async_operation.h"
 #include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <utility>
+#include "xynet/detail/async_operation.h"
+#include "xynet/detail/file_descriptor_traits.h"
 
 namespace xynet
 {
 
-template<detail::FileDescriptorPolicy P, typename F>
-struct operation_splice
+/// the capacity requested for the pipe of a splice. The kernel caps it at
+/// /proc/sys/fs/pipe-max-size, the default pipe capacity(64KiB) is kept if the
+/// request is refused.
+inline constexpr int splice_pipe_capacity = 256 * 1024;
+
+namespace detail
+{
+
+/// \brief the pipe that splice(2) moves the pages of a socket through.
+///        It is created on the first splice and reused by the later ones. Bytes
+///        spliced into the pipe but not out of it yet, e.g. because the output
+///        failed, are kept and drained first by the next splice.
+class splice_pipe
 {
-  template<typename F2, bool enable_timeout = false>
-  struct async_splice : public async_operation<P, async_splice<F2, enable_timeout>, enable_timeout>
+public:
+  splice_pipe() noexcept = default;
+
+  splice_pipe(splice_pipe&& other) noexcept
+  :m_read_fd{std::exchange(other.m_read_fd, -1)}
+  ,m_write_fd{std::exchange(other.m_write_fd, -1)}
+  ,m_capacity{std::exchange(other.m_capacity, 0)}
+  ,m_buffered{std::exchange(other.m_buffered, 0)}
+  {}
+
+  splice_pipe& operator=(splice_pipe&& other) noexcept
+  {
+    if(this != &other)
+    {
+      close();
+      m_read_fd  = std::exchange(other.m_read_fd, -1);
+      m_write_fd = std::exchange(other.m_write_fd, -1);
+      m_capacity = std::exchange(other.m_capacity, 0);
+      m_buffered = std::exchange(other.m_buffered, 0);
+    }
+    return *this;
+  }
+
+  ~splice_pipe()
   {
+    close();
+  }
 
-    async_splice(F& socket, F2& file, long int len) noexcept
-    requires(enable_timeout == false)
-    : async_operation<P, async_splice<F2, enable_timeout>, enable_timeout>{}
-    , m_socket{socket}
-    , m_file{file}
-    , m_len{static_cast<::size_t>(len)}
-    {}
-
-    template<typename Duration, bool enable_timeout2 = enable_timeout>
-    requires (enable_timeout2 == true)
-    async_splice(F& socket, F2& file, long int len, Duration&& duration)
-    noexcept
-    : async_operation<P, async_splice<F2, enable_timeout>, enable_timeout>{std::forward<Duration>(duration)}
-    , m_socket{socket}
-    , m_file{file}
-    , m_len{static_cast<::size_t>(len)}
-    {}
-
-    auto initial_check() const noexcept
-    {  
-      return true;
+  /// \return 0 on success, otherwise the errno of pipe2(2).
+  auto open() noexcept -> int
+  {
+    if(valid())
+    {
+      return 0;
     }
 
-    static void on_splice_completed(async_operation_base *base) noexcept
+    int fds[2];
+    if(::pipe2(fds, O_CLOEXEC) < 0)
     {
-      auto *op = static_cast<async_splice*>(base);
-      op->update_result();
+      return errno;
     }
 
-    void update_result()
+    m_read_fd  = fds[0];
+    m_write_fd = fds[1];
+    ::fcntl(m_write_fd, F_SETPIPE_SZ, splice_pipe_capacity);
+    auto capacity = ::fcntl(m_write_fd, F_GETPIPE_SZ);
+    m_capacity = capacity > 0 ? static_cast<std::size_t>(capacity) : 64 * 1024;
+    return 0;
+  }
+
+  void close() noexcept
+  {
+    if(valid())
+    {
+      ::close(std::exchange(m_read_fd, -1));
+      ::close(std::exchange(m_write_fd, -1));
+      m_buffered = 0;
+    }
+  }
+
+  [[nodiscard]] bool valid() const noexcept { return m_read_fd >= 0; }
+  [[nodiscard]] int read_fd() const noexcept { return m_read_fd; }
+  [[nodiscard]] int write_fd() const noexcept { return m_write_fd; }
+  [[nodiscard]] std::size_t capacity() const noexcept { return m_capacity; }
+  [[nodiscard]] std::size_t buffered() const noexcept { return m_buffered; }
+
+  void fill(std::size_t bytes) noexcept { m_buffered += bytes; }
+  void drain(std::size_t bytes) noexcept { m_buffered -= bytes; }
+
+private:
+  int m_read_fd  = -1;
+  int m_write_fd = -1;
+  std::size_t m_capacity = 0;
+  std::size_t m_buffered = 0;
+};
+
+}
+
+/// \brief move up to len bytes from in(a socket or a file) to the file descriptor out without
+///        copying them into the user space: IORING_OP_SPLICE moves them from in into a pipe,
+///        and then from the pipe into out, until len bytes are moved or in reaches EOF.
+///        io_uring can not poll for splice(2), a splice from a socket without data would block
+///        an io-wq worker until data arrives. So a socket is polled for POLLIN first, unless
+///        the previous splice from it filled what it asked for.
+template<typename Policy, typename F, typename F2>
+class async_splice : public async_operation<Policy, async_splice<Policy, F, F2>>
+{
+public:
+  template<typename... Args>
+  async_splice(F& in, detail::splice_pipe& pipe, F2& out, std::size_t len, Args&&... args) noexcept
+  :async_splice{in, -1, pipe, out, -1, len, std::forward<Args>(args)...}
+  {}
+
+  /// \param in_offset  the offset of in to read from, or -1 to read from the current position.
+  /// \param out_offset the offset of out to write to, or -1 to write to the current position.
+  ///                   A file is read or written at the offset without changing its position.
+  template<typename... Args>
+  async_splice(F& in, std::int64_t in_offset, detail::splice_pipe& pipe,
+               F2& out, std::int64_t out_offset, std::size_t len, Args&&... args) noexcept
+  :async_operation<Policy, async_splice<Policy, F, F2>>
+    {&async_splice::on_splice_completed, std::forward<Args>(args)...}
+  ,m_in{in}
+  ,m_in_offset{in_offset}
+  ,m_pipe{pipe}
+  ,m_out{out}
+  ,m_out_offset{out_offset}
+  ,m_len{len}
+  ,m_open_error{pipe.open()}
+  {}
+
+private:
+  auto initial_check() const noexcept
+  {
+    return true;
+  }
+
+  static void on_splice_completed(async_operation_base *base) noexcept
+  {
+    auto *op = static_cast<async_splice*>(base);
+    op->update_result();
+  }
+
+  [[nodiscard]]
+  auto try_start() noexcept
+  {
+    return [this](::io_uring_sqe* sqe)
     {
-      if(!async_operation_base::no_error_in_result() || async_operation_base::get_res() == 0)
+      if(m_open_error)
       {
-        async_operation_base::get_awaiting_coroutine().resume();
+        ::io_uring_prep_nop(sqe);
+      }
+      else if(m_pipe.buffered() > 0)
+      {
+        m_draining = true;
+        m_polling  = false;
+        ::io_uring_prep_splice(sqe,
+          m_pipe.read_fd(), -1,
+          m_out.get(), m_out_offset,
+          static_cast<unsigned int>(std::min(m_pipe.buffered(), m_len - m_bytes_transferred)), SPLICE_F_MOVE);
+      }
+      else if(m_wait_readable)
+      {
+        m_draining = false;
+        m_polling  = true;
+        ::io_uring_prep_poll_add(sqe, m_in.get(), POLLIN);
       }
       else
       {
-        m_bytes_transferred += async_operation_base::get_res();
-        async_operation<P, async_splice<F2, enable_timeout>, enable_timeout>::submit();
+        m_draining = false;
+        m_polling  = false;
+        m_requested = std::min(m_len - m_bytes_transferred, m_pipe.capacity());
+        ::io_uring_prep_splice(sqe,
+          m_in.get(), m_in_offset,
+          m_pipe.write_fd(), -1,
+          static_cast<unsigned int>(m_requested), SPLICE_F_MOVE);
       }
+
+      sqe->user_data = reinterpret_cast<uintptr_t>(this);
+    };
+  }
+
+  void update_result()
+  {
+    if(m_open_error)[[unlikely]]
+    {
+      async_operation_base::get_error_code().assign(m_open_error, std::system_category());
+      async_operation_base::get_awaiting_coroutine().resume();
+      return;
+    }
+
+    if(async_operation_base::get_error_code() || async_operation_base::get_res() == 0)
+    {
+      // an error, or EOF of in. The bytes left in the pipe are kept for the next splice.
+      async_operation_base::get_awaiting_coroutine().resume();
+      return;
     }
 
-    auto try_start() noexcept
+    auto res = static_cast<std::size_t>(async_operation_base::get_res());
+    if(m_polling)
+    {
+      // in is readable(or hung up, which the splice reports as EOF).
+      m_wait_readable = false;
+    }
+    else if(m_draining)
+    {
+      m_pipe.drain(res);
+      m_bytes_transferred += res;
+      if(m_out_offset >= 0)
+      {
+        m_out_offset += static_cast<std::int64_t>(res);
+      }
+    }
+    else
     {
-      return [this](::io_uring_sqe *sqe)
+      m_pipe.fill(res);
+      if(m_in_offset >= 0)
       {
-        ::io_uring_prep_splice
-        (sqe, 
-        m_file.get(),   -1,
-        m_socket.get(), -1,
-        m_len, m_splice_flags);
-
-        sqe->user_data = reinterpret_cast<uintptr_t>(this);
-      };
+        m_in_offset += static_cast<std::int64_t>(res);
+      }
+      m_wait_readable = in_is_socket && res < m_requested;
     }
 
-    auto get_result()
-    noexcept (detail::FileDescriptorPolicyUseErrorCode<P>)
-    -> detail::file_descriptor_operation_return_type_t<P, std::size_t>
+    // the bytes in the pipe beyond len are kept for the next splice.
+    if(m_bytes_transferred < m_len)
     {
-      return async_throw_or_return<P, std::size_t>
-        (async_operation_base::get_error_code(), m_bytes_transferred);
+      async_operation<Policy, async_splice<Policy, F, F2>>::submit();
     }
-  private:
-    F&  m_socket;
-    F2& m_file;
-    std::size_t m_bytes_transferred;
-    ::size_t m_len;
-    unsigned int m_splice_flags = 0;
-  };
+    else
+    {
+      async_operation_base::get_awaiting_coroutine().resume();
+    }
+  }
+
+  auto get_result() noexcept (Policy::error_code_type::value) -> std::size_t
+  {
+    if constexpr (!Policy::error_code_type::value)
+    {
+      if(async_operation_base::get_error_code())[[unlikely]]
+      {
+        throw std::system_error{async_operation_base::get_error_code()};
+      }
+    }
+    return m_bytes_transferred;
+  }
 
+  inline static constexpr bool in_is_socket = requires { F::socket_domain; };
 
+  friend async_operation<Policy, async_splice<Policy, F, F2>>;
+  F&  m_in;
+  std::int64_t m_in_offset;
+  detail::splice_pipe& m_pipe;
+  F2& m_out;
+  std::int64_t m_out_offset;
+  std::size_t m_len;
+  std::size_t m_bytes_transferred = 0;
+  std::size_t m_requested = 0;
+  int  m_open_error;
+  bool m_draining = false;
+  bool m_polling  = false;
+  bool m_wait_readable = in_is_socket;
+};
+
+template<typename F, typename F2, typename... Args>
+async_splice(F& in, detail::splice_pipe& pipe, F2& out, std::size_t len, Args&&... args) noexcept
+-> async_splice<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F, F2>;
+
+template<typename F, typename F2, typename... Args>
+async_splice(F& in, std::int64_t in_offset, detail::splice_pipe& pipe,
+             F2& out, std::int64_t out_offset, std::size_t len, Args&&... args) noexcept
+-> async_splice<typename async_operation_traits<std::decay_t<Args>...>::policy_type, F, F2>;
+
+template<typename F>
+class operation_splice
+{
+public:
+  /// \brief      Create an awaiter to move up to len bytes from this socket to out through
+  ///             the pipe of this socket. The awaiter returns the number of bytes moved, which
+  ///             is less than len only if this socket reaches EOF or an error occurs.
+  /// \param      out  a socket, pipe or file that the bytes will be moved to.
+  /// \param      len  the maximum number of bytes to move, std::numeric_limits<std::size_t>::max()
+  ///                  to move until EOF.
+  /// \param      args
+  ///
+  /// 1. Args is void:
+  ///   The awaiter returned by the function will throw exception to report the error.
+  ///
+  /// 2. Args is a Duration, i.e. std::chrono::duration<Rep, Period>.
+  ///   This duration will be treated as the timeout for each splice(2) in the chain.
+  ///
+  /// 3. Args is an lvalue reference of a std::error_code
+  ///   The awaiter returned by the function will use std::error_code to report the error.
+  ///
+  /// 4. Args are first a Duration, second an lvalue reference of a std::error_code
+  ///   The operation will have the features described in 2 and 3.
+  ///
+  /// \note This socket is polled for POLLIN before it is spliced from, so an idle connection
+  ///       waits in the ring rather than in an io-wq worker.
   template<typename F2, typename... Args>
   [[nodiscard]]
-  decltype(auto) splice(F2&& file, Args&&... args) noexcept 
+  decltype(auto) splice_to(F2& out, std::size_t len, Args&&... args) noexcept
   {
-    return async_splice<F2, false>{*static_cast<F*>(this), 
-    std::forward<F2>(file), 
-    std::forward<Args>(args)...};
+    return async_splice{*static_cast<F*>(this), m_splice_pipe, out, len, std::forward<Args>(args)...};
   }
+
+  /// \brief the number of bytes read from this socket but not moved to the output yet.
+  [[nodiscard]]
+  auto splice_buffered_bytes() const noexcept -> std::size_t
+  {
+    return m_splice_pipe.buffered();
+  }
+
+private:
+  detail::splice_pipe m_splice_pipe;
 };
 
 }
 
-#endif //XYNET_ACCEPT_H
+#endif //XYNET_SOCKET_SPLICE_H
@@ -0,0 +1,262 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_TIMESTAMPING_H
+#define XYNET_SOCKET_TIMESTAMPING_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <optional>
+#include <system_error>
+#include <vector>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+#include <linux/net_tstamp.h>
+#include "xynet/detail/sync_operation.h"
+
+namespace xynet
+{
+
+/// \brief what SO_TIMESTAMPING reports. The timestamps are taken by the kernel in software,
+///        on CLOCK_REALTIME, so they compare with std::chrono::system_clock::now().
+struct timestamping_options
+{
+  /// when a packet was received by the stack, returned by recv_some_timestamped().
+  bool rx = true;
+  /// when a send entered the packet scheduler.
+  bool tx_scheduled = false;
+  /// when a send was passed to the driver.
+  bool tx_sent = true;
+  /// when all the bytes of a send were acknowledged by the peer(TCP only).
+  bool tx_acked = false;
+};
+
+/// \brief the result of recv_some_timestamped().
+struct timestamped_recv
+{
+  std::size_t bytes;
+  /// empty if timestamping is not enabled on the socket, or the kernel did not report one.
+  std::optional<std::chrono::system_clock::time_point> kernel_time;
+};
+
+enum class tx_timestamp_type
+{
+  sent      = SCM_TSTAMP_SND,
+  scheduled = SCM_TSTAMP_SCHED,
+  acked     = SCM_TSTAMP_ACK,
+};
+
+/// \brief a transmit timestamp read from the error queue.
+struct tx_timestamp
+{
+  /// for a TCP socket, the offset of the last byte of the send counted from the first byte sent
+  /// after timestamping was enabled. For other sockets, the number of the send.
+  std::uint32_t id;
+  tx_timestamp_type type;
+  std::chrono::system_clock::time_point time;
+};
+
+namespace detail
+{
+
+inline auto to_time_point(const ::timespec& ts) noexcept
+{
+  return std::chrono::system_clock::time_point
+  {
+    std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::seconds{ts.tv_sec} + std::chrono::nanoseconds{ts.tv_nsec})
+  };
+}
+
+/// \brief the SCM_TIMESTAMPING software timestamp of a message, if there is one.
+inline auto find_software_timestamp(const ::msghdr& msg) noexcept
+-> std::optional<std::chrono::system_clock::time_point>
+{
+  for(auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(const_cast<::msghdr*>(&msg), cmsg))
+  {
+    if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPING)
+    {
+      auto stamps = ::scm_timestamping{};
+      std::memcpy(&stamps, CMSG_DATA(cmsg), sizeof(stamps));
+      // ts[0] is the software timestamp, ts[2] the hardware one.
+      if(stamps.ts[0].tv_sec != 0 || stamps.ts[0].tv_nsec != 0)
+      {
+        return to_time_point(stamps.ts[0]);
+      }
+    }
+  }
+  return std::nullopt;
+}
+
+/// the control buffer of a timestamped recvmsg, empty for the other ones.
+template<bool enable_timestamp>
+struct recv_timestamp_storage
+{
+  void prepare(::msghdr& msg) noexcept
+  {
+    msg.msg_control    = m_control.data();
+    msg.msg_controllen = m_control.size();
+  }
+
+  void parse(const ::msghdr& msg) noexcept
+  {
+    if(!m_time)
+    {
+      m_time = find_software_timestamp(msg);
+    }
+  }
+
+  alignas(::cmsghdr) std::array<std::byte, CMSG_SPACE(sizeof(::scm_timestamping))> m_control{};
+  std::optional<std::chrono::system_clock::time_point> m_time;
+};
+
+template<>
+struct recv_timestamp_storage<false>
+{
+  void prepare(::msghdr&) noexcept {}
+  void parse(const ::msghdr&) noexcept {}
+};
+
+}
+
+template<typename F>
+struct operation_timestamping
+{
+  /// \brief enable SO_TIMESTAMPING with software timestamps. report error by error_code.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto enable_timestamping(const timestamping_options& options, std::error_code& error) noexcept
+  -> void
+  {
+    int flags = SOF_TIMESTAMPING_SOFTWARE;
+    if(options.rx)
+    {
+      flags |= SOF_TIMESTAMPING_RX_SOFTWARE;
+    }
+    if(options.tx_scheduled || options.tx_sent || options.tx_acked)
+    {
+      // number the sends, and do not loop the payload back to the error queue.
+      flags |= SOF_TIMESTAMPING_OPT_ID | SOF_TIMESTAMPING_OPT_TSONLY;
+    }
+    flags |= options.tx_scheduled ? SOF_TIMESTAMPING_TX_SCHED    : 0;
+    flags |= options.tx_sent      ? SOF_TIMESTAMPING_TX_SOFTWARE : 0;
+    flags |= options.tx_acked     ? SOF_TIMESTAMPING_TX_ACK      : 0;
+    set_timestamping(flags, error);
+  }
+
+  /// \brief same as enable_timestamping(options, error), but report error by exception.
+  auto enable_timestamping(const timestamping_options& options = {}) -> void
+  {
+    auto error = std::error_code{};
+    enable_timestamping(options, error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief disable SO_TIMESTAMPING. report error by error_code.
+  auto disable_timestamping(std::error_code& error) noexcept -> void
+  {
+    set_timestamping(0, error);
+  }
+
+  /// \brief disable SO_TIMESTAMPING. report error by exception.
+  auto disable_timestamping() -> void
+  {
+    auto error = std::error_code{};
+    disable_timestamping(error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+  }
+
+  /// \brief read the transmit timestamps queued on the error queue so far, without blocking.
+  ///        A send is timestamped when it leaves the stack or is acknowledged, after the send
+  ///        operation has completed, so call this after the send, e.g. before the next one.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto tx_timestamps(std::error_code& error) noexcept -> std::vector<tx_timestamp>
+  {
+    error.clear();
+    auto timestamps = std::vector<tx_timestamp>{};
+    auto fd = static_cast<F*>(this)->get();
+
+    for(;;)
+    {
+      alignas(::cmsghdr) std::array<std::byte, 256> control{};
+      auto msg = ::msghdr
+      {
+        .msg_control    = control.data(),
+        .msg_controllen = control.size()
+      };
+      if(::recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+      {
+        if(errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+          error.assign(errno, std::system_category());
+        }
+        return timestamps;
+      }
+
+      // a timestamp comes as a SCM_TIMESTAMPING cmsg followed by a sock_extended_err
+      // that tells which send it belongs to.
+      auto time = detail::find_software_timestamp(msg);
+      for(auto* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg))
+      {
+        if((cmsg->cmsg_level == SOL_IP   && cmsg->cmsg_type == IP_RECVERR)
+        || (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+        {
+          auto err = ::sock_extended_err{};
+          std::memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+          if(err.ee_origin == SO_EE_ORIGIN_TIMESTAMPING && time)
+          {
+            timestamps.push_back(tx_timestamp
+            {
+              .id   = err.ee_data,
+              .type = static_cast<tx_timestamp_type>(err.ee_info),
+              .time = *time
+            });
+          }
+        }
+      }
+    }
+  }
+
+  /// \brief same as tx_timestamps(error), but report error by exception.
+  auto tx_timestamps() -> std::vector<tx_timestamp>
+  {
+    auto error = std::error_code{};
+    auto timestamps = tx_timestamps(error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+    return timestamps;
+  }
+
+private:
+  void set_timestamping(int flags, std::error_code& error) noexcept
+  {
+    detail::sync_operation
+    (
+      [fd = static_cast<const F*>(this)->get(), flags]()
+      {
+        return ::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPING, &flags, sizeof(flags));
+      },
+      []([[maybe_unused]]int ret){},
+      error
+    );
+  }
+};
+
+}
+
+#endif //XYNET_SOCKET_TIMESTAMPING_H
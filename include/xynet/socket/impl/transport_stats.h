@@ -0,0 +1,272 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_TRANSPORT_STATS_H
+#define XYNET_SOCKET_TRANSPORT_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "xynet/io_service.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/detail/sync_operation.h"
+
+namespace xynet
+{
+
+/// \brief a sample of TCP_INFO. Fields the running kernel does not report are 0.
+struct tcp_info_sample
+{
+  std::chrono::microseconds rtt{};
+  std::chrono::microseconds rttvar{};
+  std::chrono::microseconds min_rtt{};
+  /// segments retransmitted over the lifetime of the connection.
+  std::uint32_t retransmits = 0;
+  /// segments currently considered lost.
+  std::uint32_t lost = 0;
+  /// congestion window, in segments of snd_mss bytes.
+  std::uint32_t cwnd = 0;
+  std::uint32_t snd_mss = 0;
+  /// segments sent but not yet acknowledged.
+  std::uint32_t unacked = 0;
+  /// bytes in the send buffer that have not been sent yet.
+  std::uint32_t notsent_bytes = 0;
+  /// bytes per second.
+  std::uint64_t delivery_rate = 0;
+  std::uint64_t pacing_rate = 0;
+  /// time the sender was limited by the receive window of the peer, i.e. a slow reader.
+  std::chrono::microseconds rwnd_limited{};
+  /// time the sender was limited by the local send buffer.
+  std::chrono::microseconds sndbuf_limited{};
+};
+
+/// \brief userspace counters of a connection. Only operations that complete are counted,
+///        ops is the number of awaited operations, not of system calls.
+struct transport_counters
+{
+  std::uint64_t bytes_sent = 0;
+  std::uint64_t bytes_received = 0;
+  std::uint64_t sends = 0;
+  std::uint64_t recvs = 0;
+  /// the io_service::loop_time() of the last completed send or receive.
+  std::chrono::steady_clock::time_point last_activity{};
+};
+
+namespace detail
+{
+
+/// the layout of struct tcp_info in linux/tcp.h, which can not be included together with
+/// netinet/tcp.h. glibc's copy stops at tcpi_total_retrans.
+struct kernel_tcp_info
+{
+  std::uint8_t  tcpi_state;
+  std::uint8_t  tcpi_ca_state;
+  std::uint8_t  tcpi_retransmits;
+  std::uint8_t  tcpi_probes;
+  std::uint8_t  tcpi_backoff;
+  std::uint8_t  tcpi_options;
+  std::uint8_t  tcpi_wscale;
+  std::uint8_t  tcpi_flags;
+
+  std::uint32_t tcpi_rto;
+  std::uint32_t tcpi_ato;
+  std::uint32_t tcpi_snd_mss;
+  std::uint32_t tcpi_rcv_mss;
+
+  std::uint32_t tcpi_unacked;
+  std::uint32_t tcpi_sacked;
+  std::uint32_t tcpi_lost;
+  std::uint32_t tcpi_retrans;
+  std::uint32_t tcpi_fackets;
+
+  std::uint32_t tcpi_last_data_sent;
+  std::uint32_t tcpi_last_ack_sent;
+  std::uint32_t tcpi_last_data_recv;
+  std::uint32_t tcpi_last_ack_recv;
+
+  std::uint32_t tcpi_pmtu;
+  std::uint32_t tcpi_rcv_ssthresh;
+  std::uint32_t tcpi_rtt;
+  std::uint32_t tcpi_rttvar;
+  std::uint32_t tcpi_snd_ssthresh;
+  std::uint32_t tcpi_snd_cwnd;
+  std::uint32_t tcpi_advmss;
+  std::uint32_t tcpi_reordering;
+
+  std::uint32_t tcpi_rcv_rtt;
+  std::uint32_t tcpi_rcv_space;
+
+  std::uint32_t tcpi_total_retrans;
+
+  std::uint64_t tcpi_pacing_rate;
+  std::uint64_t tcpi_max_pacing_rate;
+  std::uint64_t tcpi_bytes_acked;
+  std::uint64_t tcpi_bytes_received;
+  std::uint32_t tcpi_segs_out;
+  std::uint32_t tcpi_segs_in;
+
+  std::uint32_t tcpi_notsent_bytes;
+  std::uint32_t tcpi_min_rtt;
+  std::uint32_t tcpi_data_segs_in;
+  std::uint32_t tcpi_data_segs_out;
+
+  std::uint64_t tcpi_delivery_rate;
+
+  std::uint64_t tcpi_busy_time;
+  std::uint64_t tcpi_rwnd_limited;
+  std::uint64_t tcpi_sndbuf_limited;
+};
+
+static_assert(offsetof(kernel_tcp_info, tcpi_total_retrans) == offsetof(::tcp_info, tcpi_total_retrans));
+
+/// \brief called by the send operations when they complete. Free unless the socket has
+///        the operation_transport_stats module.
+template<typename F>
+void count_sent(F& socket, std::size_t bytes, io_service* service) noexcept
+{
+  if constexpr (requires { socket.transport_stats(); })
+  {
+    socket.on_sent(bytes, service);
+  }
+}
+
+/// \brief called by the receive operations when they complete.
+template<typename F>
+void count_received(F& socket, std::size_t bytes, io_service* service) noexcept
+{
+  if constexpr (requires { socket.transport_stats(); })
+  {
+    socket.on_received(bytes, service);
+  }
+}
+
+}
+
+template<typename F>
+struct operation_transport_stats
+{
+  /// \brief sample getsockopt(TCP_INFO). report error by error_code.
+  /// \param[out] the std::error_code will be reset if there is an error. Otherwise, if
+  ///             will be cleared.
+  auto tcp_info(std::error_code& error) const noexcept -> tcp_info_sample
+  {
+    auto info = detail::kernel_tcp_info{};
+    auto len = static_cast<::socklen_t>(sizeof(info));
+    detail::sync_operation
+    (
+      [fd = static_cast<const F*>(this)->get(), &info, &len]()
+      {
+        return ::getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len);
+      },
+      []([[maybe_unused]]int ret){},
+      error
+    );
+
+    auto sample = tcp_info_sample{};
+    if(error)
+    {
+      return sample;
+    }
+
+    // an older kernel fills only a prefix of the struct.
+    using info_t = detail::kernel_tcp_info;
+    sample.rtt         = std::chrono::microseconds{info.tcpi_rtt};
+    sample.rttvar      = std::chrono::microseconds{info.tcpi_rttvar};
+    sample.retransmits = info.tcpi_total_retrans;
+    sample.lost        = info.tcpi_lost;
+    sample.cwnd        = info.tcpi_snd_cwnd;
+    sample.snd_mss     = info.tcpi_snd_mss;
+    sample.unacked     = info.tcpi_unacked;
+    if(len >= offsetof(info_t, tcpi_max_pacing_rate))
+    {
+      sample.pacing_rate = info.tcpi_pacing_rate;
+    }
+    if(len >= offsetof(info_t, tcpi_data_segs_in))
+    {
+      sample.notsent_bytes = info.tcpi_notsent_bytes;
+      sample.min_rtt       = std::chrono::microseconds{info.tcpi_min_rtt};
+    }
+    if(len >= offsetof(info_t, tcpi_busy_time))
+    {
+      sample.delivery_rate = info.tcpi_delivery_rate;
+    }
+    if(len >= sizeof(info_t))
+    {
+      sample.rwnd_limited   = std::chrono::microseconds{info.tcpi_rwnd_limited};
+      sample.sndbuf_limited = std::chrono::microseconds{info.tcpi_sndbuf_limited};
+    }
+    return sample;
+  }
+
+  /// \brief sample getsockopt(TCP_INFO). report error by exception.
+  auto tcp_info() const -> tcp_info_sample
+  {
+    auto error = std::error_code{};
+    auto sample = tcp_info(error);
+    if(error)
+    {
+      throw std::system_error{error};
+    }
+    return sample;
+  }
+
+  /// \brief call on_sample(tcp_info_sample) every interval on the io_service timer until token
+  ///        is stopped or the sample fails, e.g. because the socket is closed. The socket must
+  ///        outlive the returned task.
+  template<typename OnSample>
+  auto sample_tcp_info(std::chrono::milliseconds interval, std::stop_token token, OnSample on_sample)
+  -> task<>
+  {
+    auto* service = io_service::get_thread_io_service();
+    while(!token.stop_requested())
+    {
+      co_await service->schedule(interval);
+      auto error = std::error_code{};
+      auto sample = tcp_info(error);
+      if(error)
+      {
+        co_return;
+      }
+      on_sample(sample);
+    }
+  }
+
+  [[nodiscard]]
+  const transport_counters& transport_stats() const noexcept
+  {
+    return m_counters;
+  }
+
+  /// \brief the time since the last completed send or receive, measured at the loop time
+  ///        of the io_service.
+  [[nodiscard]]
+  std::chrono::nanoseconds idle_time(const io_service& service) const noexcept
+  {
+    return service.loop_time() - m_counters.last_activity;
+  }
+
+  void on_sent(std::size_t bytes, io_service* service) noexcept
+  {
+    m_counters.bytes_sent += bytes;
+    ++m_counters.sends;
+    m_counters.last_activity = service->loop_time();
+  }
+
+  void on_received(std::size_t bytes, io_service* service) noexcept
+  {
+    m_counters.bytes_received += bytes;
+    ++m_counters.recvs;
+    m_counters.last_activity = service->loop_time();
+  }
+
+private:
+  transport_counters m_counters;
+};
+
+}
+
+#endif //XYNET_SOCKET_TRANSPORT_STATS_H
@@ -0,0 +1,97 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_UNIX_ADDRESS_H
+#define XYNET_SOCKET_UNIX_ADDRESS_H
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <ostream>
+
+namespace xynet
+{
+
+/// \brief the AF_UNIX counterpart of socket_address.
+///        A path starting with '@' names a socket in the abstract namespace, which
+///        does not create a file and disappears with the last socket bound to it.
+class unix_socket_address
+{
+public:
+  unix_socket_address() noexcept
+  :m_sockaddr{.sun_family = AF_UNIX}
+  ,m_size{offsetof(::sockaddr_un, sun_path)}
+  {}
+
+  /// \note the path is truncated if it does not fit in sockaddr_un::sun_path.
+  explicit unix_socket_address(std::string_view path) noexcept
+  :unix_socket_address{}
+  {
+    auto len = std::min(path.size(), sizeof(m_sockaddr.sun_path) - 1);
+    std::memcpy(m_sockaddr.sun_path, path.data(), len);
+    if(len > 0 && path.front() == '@')
+    {
+      // abstract: the name is all the bytes after the leading '\0', no terminator.
+      m_sockaddr.sun_path[0] = '\0';
+      m_size += static_cast<::socklen_t>(len);
+    }
+    else
+    {
+      m_size += static_cast<::socklen_t>(len + 1);
+    }
+  }
+
+  unix_socket_address(const ::sockaddr_un& addr, ::socklen_t size) noexcept
+  :m_sockaddr{addr}
+  ,m_size{size}
+  {}
+
+  [[nodiscard]]
+  bool is_abstract() const noexcept
+  {
+    return m_size > offsetof(::sockaddr_un, sun_path) && m_sockaddr.sun_path[0] == '\0';
+  }
+
+  /// \brief the path of the socket, with '@' in place of the leading '\0' of an abstract name.
+  std::string to_str() const
+  {
+    auto len = static_cast<std::size_t>(m_size - offsetof(::sockaddr_un, sun_path));
+    if(is_abstract())
+    {
+      return "@" + std::string{m_sockaddr.sun_path + 1, len - 1};
+    }
+    return std::string{m_sockaddr.sun_path, ::strnlen(m_sockaddr.sun_path, len)};
+  }
+
+  friend std::ostream& operator<<(std::ostream& stream, const unix_socket_address& address)
+  {
+    stream<<address.to_str();
+    return stream;
+  }
+
+  [[nodiscard]]
+  const ::sockaddr_un* as_sockaddr_un() const noexcept
+  {
+    return &m_sockaddr;
+  }
+
+  /// \brief the length of the address to pass to bind(2)/connect(2).
+  [[nodiscard]]
+  ::socklen_t size() const noexcept
+  {
+    return m_size;
+  }
+
+private:
+  ::sockaddr_un m_sockaddr;
+  ::socklen_t m_size;
+};
+
+}
+
+#endif //XYNET_SOCKET_UNIX_ADDRESS_H
@@ -0,0 +1,89 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_PROXY_H
+#define XYNET_SOCKET_PROXY_H
+
+#include <limits>
+#include <system_error>
+#include <sys/socket.h>
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+
+namespace xynet
+{
+
+struct proxy_result
+{
+  std::size_t forwarded_bytes;  // from a to b
+  std::size_t backward_bytes;   // from b to a
+};
+
+namespace detail
+{
+
+/// \brief splice in to out until in reaches EOF, then pass the EOF on to out.
+///        On an error, both sockets are shut down so that the relay of the other
+///        direction does not wait for data forever.
+template<typename F, typename F2>
+auto proxy_one_way(F& in, F2& out, std::error_code& error) -> task<std::size_t>
+{
+  auto direction_error = std::error_code{};
+  auto bytes = co_await in.splice_to(out, std::numeric_limits<std::size_t>::max(), direction_error);
+
+  auto ignored = std::error_code{};
+  if(!direction_error)
+  {
+    out.shutdown(SHUT_WR, ignored);
+  }
+  else
+  {
+    if(!error)
+    {
+      error = direction_error;
+    }
+    in.shutdown(SHUT_RDWR, ignored);
+    out.shutdown(SHUT_RDWR, ignored);
+  }
+
+  co_return bytes;
+}
+
+}
+
+/// \brief relay bytes between a and b in both directions with splice(2), so that the
+///        bytes never enter the user space, until both directions reach EOF or either
+///        of them fails. Each direction uses the splice pipe of the socket it reads from.
+/// \param[out] error the first error of either direction. Otherwise, it will be cleared.
+/// \note  the sockets are shut down but not closed. An idle direction waits for POLLIN in
+///        the ring, it does not hold an io-wq worker.
+template<typename F, typename F2>
+auto proxy(F& a, F2& b, std::error_code& error) -> task<proxy_result>
+{
+  error.clear();
+  auto [forwarded_bytes, backward_bytes] = co_await when_all
+  (
+    detail::proxy_one_way(a, b, error),
+    detail::proxy_one_way(b, a, error)
+  );
+  co_return proxy_result{forwarded_bytes, backward_bytes};
+}
+
+/// \brief same as proxy(a, b, error), but report the error by exception.
+template<typename F, typename F2>
+auto proxy(F& a, F2& b) -> task<proxy_result>
+{
+  auto error = std::error_code{};
+  auto result = co_await proxy(a, b, error);
+  if(error)
+  {
+    throw std::system_error{error};
+  }
+  co_return result;
+}
+
+}
+
+#endif //XYNET_SOCKET_PROXY_H
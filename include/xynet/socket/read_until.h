@@ -0,0 +1,93 @@
+//
+// Created by xuanyi on 10/19/26.
+//
+
+#ifndef XYNET_SOCKET_READ_UNTIL_H
+#define XYNET_SOCKET_READ_UNTIL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <system_error>
+
+#include "xynet/stream_buffer.h"
+#include "xynet/coroutine/task.h"
+#include "xynet/detail/find_delimiter.h"
+
+namespace xynet
+{
+
+/// the most bytes that read_until() receives at a time.
+inline constexpr std::size_t read_until_chunk_size = 4096;
+
+/// \brief receive into buffer until its readable bytes contain delimiter, e.g. "\n" for a line
+///        or "\r\n\r\n" for the headers of an http request. The bytes already in buffer are
+///        looked at first, and each recv only scans the bytes it received, plus the ones a
+///        delimiter split by the recv may start in, with detail::find_delimiter().
+/// \param[in]  max_size  fail with std::errc::message_size if this many bytes have been read
+///                       without a delimiter.
+/// \param[out] error     the error of the recv, e.g. xynet_error::eof. Otherwise, it will be
+///                       cleared.
+/// \return the readable bytes of buffer up to and including the delimiter, without copying
+///         them. They stay valid until buffer is prepared or consumed, the caller consumes
+///         them once it is done. Empty on error.
+template<typename F>
+auto read_until(F& socket, stream_buffer& buffer, std::string_view delimiter,
+                std::size_t max_size, std::error_code& error) -> task<std::span<const std::byte>>
+{
+  error.clear();
+  // the readable bytes before it do not start a delimiter.
+  auto scanned = std::size_t{};
+  for(;;)
+  {
+    auto data  = buffer.data_string_view();
+    auto* last = data.data() + data.size();
+    if(auto* found = detail::find_delimiter(data.data() + scanned, last, delimiter); found != last)
+    {
+      co_return buffer.data().first(static_cast<std::size_t>(found - data.data()) + delimiter.size());
+    }
+
+    if(data.size() >= max_size)
+    {
+      error = std::make_error_code(std::errc::message_size);
+      co_return std::span<const std::byte>{};
+    }
+    scanned = data.size() - std::min(data.size(), delimiter.size() - 1);
+
+    auto received = co_await socket.recv_some(error,
+      buffer.prepare(std::min(read_until_chunk_size, max_size - data.size())));
+    if(error)
+    {
+      co_return std::span<const std::byte>{};
+    }
+    buffer.commit(received);
+  }
+}
+
+/// \brief same as read_until(socket, buffer, delimiter, max_size, error), without a limit.
+template<typename F>
+auto read_until(F& socket, stream_buffer& buffer, std::string_view delimiter,
+                std::error_code& error) -> task<std::span<const std::byte>>
+{
+  return read_until(socket, buffer, delimiter, SIZE_MAX, error);
+}
+
+/// \brief same as read_until(socket, buffer, delimiter, max_size, error), but report the error
+///        by exception.
+template<typename F>
+auto read_until(F& socket, stream_buffer& buffer, std::string_view delimiter,
+                std::size_t max_size = SIZE_MAX) -> task<std::span<const std::byte>>
+{
+  auto error = std::error_code{};
+  auto bytes = co_await read_until(socket, buffer, delimiter, max_size, error);
+  if(error)
+  {
+    throw std::system_error{error};
+  }
+  co_return bytes;
+}
+
+}
+
+#endif //XYNET_SOCKET_READ_UNTIL_H
@@ -15,10 +15,18 @@
 
 #include "xynet/socket/impl/accept.h"
 #include "xynet/socket/impl/connect.h"
+#include "xynet/socket/impl/open_connect.h"
+#include "xynet/socket/impl/connect_any.h"
 #include "xynet/socket/impl/send_all.h"
+#include "xynet/socket/impl/send_zc.h"
+#include "xynet/socket/impl/send_queue.h"
 #include "xynet/socket/impl/recv_all.h"
 #include "xynet/socket/impl/close.h"
-// #include "xynet/socket/impl/splice.h"
+#include "xynet/socket/impl/datagram.h"
+#include "xynet/socket/impl/fd_passing.h"
+#include "xynet/socket/impl/splice.h"
+#include "xynet/socket/impl/transport_stats.h"
+#include "xynet/socket/impl/timestamping.h"
 
 namespace xynet
 {
@@ -35,8 +43,63 @@ using socket_t = file_descriptor
     operation_listen,
     operation_accept,
     operation_connect,
+    operation_open_connect,
+    operation_connect_any,
     operation_send,
+    operation_send_zc,
+    operation_send_queue,
     operation_recv,
+    operation_splice,
+    operation_transport_stats,
+    operation_timestamping,
+    operation_close
+  >
+>;
+
+using udp_socket_t = file_descriptor
+<
+  detail::module_list
+  <
+    udp_socket_init,
+    address,
+    operation_set_options,
+    operation_bind,
+    operation_datagram,
+    operation_close
+  >
+>;
+
+using unix_stream_socket_t = file_descriptor
+<
+  detail::module_list
+  <
+    unix_stream_socket_init,
+    operation_shutdown,
+    operation_set_options,
+    operation_bind,
+    operation_listen,
+    operation_accept,
+    operation_connect,
+    operation_send,
+    operation_recv,
+    operation_send_queue,
+    operation_splice,
+    operation_fd_passing,
+    operation_close
+  >
+>;
+
+using unix_datagram_socket_t = file_descriptor
+<
+  detail::module_list
+  <
+    unix_datagram_socket_init,
+    operation_set_options,
+    operation_bind,
+    operation_connect,
+    operation_send,
+    operation_recv,
+    operation_fd_passing,
     operation_close
   >
 >;
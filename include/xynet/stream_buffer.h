@@ -1,7 +1,11 @@
+#ifndef XYNET_STREAM_BUFFER_H
+#define XYNET_STREAM_BUFFER_H
+
 #include <span>
 #include <vector>
 #include <streambuf>
 #include <cstring>
+#include <string_view>
 
 namespace xynet
 {
@@ -136,3 +140,5 @@ private:
 };
 
 }
+
+#endif //XYNET_STREAM_BUFFER_H
@@ -0,0 +1,77 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/admission_control.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <chrono>
+#include <stop_token>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("admission_control")
+{
+  auto service = io_service{};
+
+  SUBCASE("max connections")
+  {
+    auto admission = admission_control{service, {.max_connections = 2}};
+    auto t1 = admission.try_admit();
+    auto t2 = admission.try_admit();
+    CHECK(t1);
+    CHECK(t2);
+    CHECK(admission.active() == 2);
+
+    auto t3 = admission.try_admit();
+    CHECK(!t3);
+    CHECK(t3.result() == admission_result::too_many_connections);
+    CHECK(admission.shed() == 1);
+
+    t1.reset();
+    CHECK(admission.active() == 1);
+    CHECK(admission.try_admit());
+    CHECK(admission.admitted() == 3);
+  }
+
+  SUBCASE("accept rate")
+  {
+    auto admission = admission_control{service, {.accept_rate = 1, .accept_burst = 2}};
+    CHECK(admission.try_admit());
+    CHECK(admission.try_admit());
+    auto ticket = admission.try_admit();
+    CHECK(!ticket);
+    CHECK(ticket.result() == admission_result::rate_limited);
+    // the tickets are released at once, the rate still applies.
+    CHECK(admission.active() == 0);
+  }
+
+  SUBCASE("loop lag")
+  {
+    auto source = stop_source{};
+    auto admission = admission_control{service, {.max_loop_lag = chrono::milliseconds{1}}};
+    CHECK(admission.try_admit());
+
+    auto busy = [&]() -> task<>
+    {
+      for(auto i = 0; i < 32; ++i)
+      {
+        co_await service.schedule(chrono::microseconds{100});
+        auto until = chrono::steady_clock::now() + chrono::milliseconds{5};
+        while(chrono::steady_clock::now() < until);
+      }
+      CHECK(service.loop_lag() > chrono::milliseconds{1});
+      auto ticket = admission.try_admit();
+      CHECK(!ticket);
+      CHECK(ticket.result() == admission_result::overloaded);
+      source.request_stop();
+    };
+
+    sync_wait(when_all(busy(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,111 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/buffer_pool.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <algorithm>
+#include <stop_token>
+#include <thread>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("buffer_pool")
+{
+  auto pool = buffer_pool{4};
+
+  SUBCASE("capacity is rounded up to the size class")
+  {
+    CHECK_EQ(pool.allocate(1).capacity(), buffer_pool::min_block_size);
+    CHECK_EQ(pool.allocate(300).capacity(), 512);
+    CHECK_EQ(pool.allocate(300).size(), 300);
+    CHECK_EQ(pool.allocate(buffer_pool::max_block_size).capacity(), buffer_pool::max_block_size);
+    CHECK_EQ(pool.allocate(buffer_pool::max_block_size + 1).capacity(), buffer_pool::max_block_size + 1);
+  }
+
+  SUBCASE("a released buffer is reused")
+  {
+    auto buffer = pool.allocate(1000);
+    auto* data = buffer.data();
+    CHECK(reinterpret_cast<uintptr_t>(data) % cache_line_size == 0);
+    buffer.reset();
+    CHECK_EQ(pool.cached(1000), 1);
+    CHECK_EQ(pool.allocate(600).data(), data);
+  }
+
+  SUBCASE("copies share the buffer until the last one is released")
+  {
+    auto buffer = pool.allocate(100);
+    CHECK(buffer.unique());
+    {
+      auto copy = buffer;
+      CHECK(!buffer.unique());
+      CHECK_EQ(copy.data(), buffer.data());
+    }
+    CHECK(buffer.unique());
+    CHECK_EQ(pool.cached(100), 0);
+    buffer.reset();
+    CHECK(!buffer);
+    CHECK_EQ(pool.cached(100), 1);
+  }
+
+  SUBCASE("at most max_cached buffers are kept per size class")
+  {
+    {
+      auto buffers = vector<pooled_buffer>{};
+      for(auto i = 0; i < 6; ++i)
+      {
+        buffers.push_back(pool.allocate(64));
+      }
+    }
+    CHECK_EQ(pool.cached(64), 4);
+  }
+
+  SUBCASE("a buffer released on another thread goes back to the pool")
+  {
+    auto buffer = pool.allocate(2000);
+    auto* data = buffer.data();
+    std::thread{[b = std::move(buffer)]() mutable { b.reset(); }}.join();
+    CHECK_EQ(pool.cached(2000), 0);
+    CHECK_EQ(pool.allocate(2000).data(), data);
+  }
+}
+
+TEST_CASE("pooled_buffer with send and recv" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto test = [&]() -> task<>
+  {
+    auto client = socket_t{};
+    auto peer = socket_t{};
+    client.init();
+    co_await when_all(client.connect(address), listen_socket.accept(peer));
+
+    auto& pool = buffer_pool::local();
+    auto message = pool.allocate(1000);
+    std::fill(message.begin(), message.end(), std::byte{'x'});
+    co_await client.send(message);
+
+    auto received = pool.allocate(1000);
+    co_await peer.recv(received);
+    CHECK(std::equal(received.begin(), received.end(), message.begin(), message.end()));
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
@@ -4,11 +4,86 @@
 #include "doctest/doctest.h"
 #include "xynet/buffer.h"
 
+#include <deque>
+#include <list>
+#include <utility>
+
 using namespace std;
 using namespace xynet;
 
+namespace
+{
+
+auto make_buffers(size_t count) -> deque<vector<byte>>
+{
+  auto buffers = deque<vector<byte>>{};
+  for(auto i = size_t{}; i < count; ++i)
+  {
+    buffers.emplace_back(10 + i);
+  }
+  return buffers;
+}
+
+}
 
 TEST_CASE("buffer sequence test")
 {
+  SUBCASE("a short range is stored in place")
+  {
+    auto buffers = make_buffers(buffer_sequence_storage<dynamic_extent>::inline_capacity);
+    auto sequence = const_buffer_sequence{buffers};
+    auto [iov, count] = sequence.get_iov_span();
+    REQUIRE_EQ(count, buffers.size());
+    CHECK(reinterpret_cast<byte*>(iov) >= reinterpret_cast<byte*>(&sequence));
+    CHECK(reinterpret_cast<byte*>(iov) < reinterpret_cast<byte*>(&sequence) + sizeof(sequence));
+    for(auto i = size_t{}; i < count; ++i)
+    {
+      CHECK_EQ(iov[i].iov_base, buffers[i].data());
+      CHECK_EQ(iov[i].iov_len, buffers[i].size());
+    }
+  }
+
+  SUBCASE("a longer range, also one of unknown size, is allocated")
+  {
+    auto from_deque = make_buffers(20);
+    auto from_list = list<vector<byte>>(from_deque.begin(), from_deque.end());
+    auto sequence = buffer_sequence{from_list};
+    auto [iov, count] = sequence.get_iov_span();
+    REQUIRE_EQ(count, 20);
+    auto it = from_list.begin();
+    for(auto i = size_t{}; i < count; ++i, ++it)
+    {
+      CHECK_EQ(iov[i].iov_base, it->data());
+      CHECK_EQ(iov[i].iov_len, it->size());
+    }
+  }
+
+  SUBCASE("commit skips the iovecs transferred in full")
+  {
+    auto buffers = make_buffers(12);
+    auto sequence = const_buffer_sequence{buffers};
+    // 10 + 11 + 12 bytes, and 5 of the next one.
+    sequence.commit(38);
+    auto [iov, count] = sequence.get_iov_span();
+    REQUIRE_EQ(count, 9);
+    CHECK_EQ(iov->iov_base, buffers[3].data() + 5);
+    CHECK_EQ(iov->iov_len, buffers[3].size() - 5);
+
+    sequence.commit(1000);
+    CHECK_EQ(sequence.get_iov_ptr(), nullptr);
+    CHECK_EQ(sequence.get_iov_cnt(), 0);
+  }
 
-}
\ No newline at end of file
+  SUBCASE("a moved sequence points to its own iovecs")
+  {
+    auto buffers = make_buffers(3);
+    auto sequence = const_buffer_sequence{buffers};
+    sequence.commit(10);
+    auto moved = std::move(sequence);
+    auto [iov, count] = moved.get_iov_span();
+    REQUIRE_EQ(count, 2);
+    CHECK(reinterpret_cast<byte*>(iov) >= reinterpret_cast<byte*>(&moved));
+    CHECK(reinterpret_cast<byte*>(iov) < reinterpret_cast<byte*>(&moved) + sizeof(moved));
+    CHECK_EQ(iov->iov_base, buffers[1].data());
+  }
+}
@@ -0,0 +1,141 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <chrono>
+#include <stop_token>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("close" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto client = socket_t{};
+  auto peer = socket_t{};
+  client.init();
+
+  auto connect = [&]() -> task<>
+  {
+    co_await when_all(client.connect(address), listen_socket.accept(peer));
+  };
+
+  SUBCASE("graceful close does not wait for the linger once the peer closes")
+  {
+    auto test = [&]() -> task<>
+    {
+      co_await connect();
+      auto closer = [&]() -> task<>
+      {
+        co_await client.close(chrono::seconds{5});
+      };
+      auto peer_closer = [&]() -> task<>
+      {
+        array<char, 1> buf{};
+        auto error = std::error_code{};
+        co_await peer.recv(error, buf);
+        CHECK(error == xynet_error_instance::make_error_code(xynet_error::eof));
+        peer.shutdown();
+        co_await peer.close();
+      };
+
+      auto start = chrono::steady_clock::now();
+      co_await when_all(closer(), peer_closer());
+      CHECK(chrono::steady_clock::now() - start < chrono::seconds{1});
+      CHECK(!client.valid());
+      CHECK(!peer.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("close cancels the operations in flight on the socket")
+  {
+    auto test = [&]() -> task<>
+    {
+      co_await connect();
+      auto reader = [&]() -> task<>
+      {
+        array<char, 16> buf{};
+        auto error = std::error_code{};
+        co_await client.recv(error, buf);
+        CHECK(error == std::errc::operation_canceled);
+      };
+      auto closer = [&]() -> task<>
+      {
+        co_await service.schedule(chrono::milliseconds{10});
+        co_await client.close(chrono::milliseconds{10});
+      };
+
+      co_await when_all(reader(), closer());
+      CHECK(!client.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("a peer that keeps sending does not pin the socket past the linger")
+  {
+    auto test = [&]() -> task<>
+    {
+      co_await connect();
+      auto flooder = [&]() -> task<>
+      {
+        array<char, 4096> buf{};
+        auto error = std::error_code{};
+        while(!error)
+        {
+          co_await peer.send(error, buf);
+        }
+      };
+      auto closer = [&]() -> task<>
+      {
+        co_await client.close(chrono::milliseconds{50});
+      };
+
+      auto start = chrono::steady_clock::now();
+      co_await when_all(flooder(), closer());
+      CHECK(chrono::steady_clock::now() - start < chrono::seconds{1});
+      CHECK(!client.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("abortive close resets the connection")
+  {
+    auto test = [&]() -> task<>
+    {
+      co_await connect();
+      co_await client.abortive_close();
+      CHECK(!client.valid());
+
+      array<char, 1> buf{};
+      auto error = std::error_code{};
+      co_await peer.recv(error, buf);
+      CHECK(error == std::errc::connection_reset);
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
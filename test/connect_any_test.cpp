@@ -0,0 +1,125 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <chrono>
+#include <stop_token>
+#include <fcntl.h>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("connect_any" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  // a listener that does not answer: its accept queue is full, so SYNs are dropped.
+  auto slow_socket = socket_t{};
+  slow_socket.init();
+  slow_socket.bind(socket_address{"127.0.0.1", 0});
+  slow_socket.listen(0);
+  auto slow_address = slow_socket.get_local_address();
+  auto fillers = array<socket_t, 2>{};
+  for(auto& filler : fillers)
+  {
+    filler.init();
+    ::fcntl(filler.get(), F_SETFL, O_NONBLOCK);
+    ::connect(filler.get(), reinterpret_cast<const ::sockaddr*>(slow_address.as_sockaddr_in()), sizeof(::sockaddr_in));
+  }
+
+  auto closed_address = socket_address{};
+  {
+    auto closed = socket_t{};
+    closed.init();
+    closed.bind(socket_address{"127.0.0.1", 0});
+    closed_address = closed.get_local_address();
+  }
+
+  SUBCASE("a refused attempt starts the next one without waiting for the stagger")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      auto peer = socket_t{};
+      auto addresses = array{closed_address, address};
+
+      auto start = chrono::steady_clock::now();
+      co_await when_all(client.connect_any(addresses, chrono::seconds{5}, chrono::seconds{5}),
+                        listen_socket.accept(peer));
+      CHECK(chrono::steady_clock::now() - start < chrono::seconds{1});
+      CHECK(client.valid());
+      CHECK(client.get_peer_address().port() == address.port());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("a slow address loses to the next one after the stagger")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      auto peer = socket_t{};
+      auto addresses = array{slow_address, address};
+
+      auto start = chrono::steady_clock::now();
+      co_await when_all(client.connect_any(addresses, chrono::seconds{5}, chrono::milliseconds{50}),
+                        listen_socket.accept(peer));
+      CHECK(chrono::steady_clock::now() - start < chrono::seconds{1});
+      CHECK(client.get_peer_address().port() == address.port());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("no address connecting within the deadline is a timeout")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      auto addresses = array{slow_address};
+      auto error = std::error_code{};
+
+      co_await client.connect_any(addresses, chrono::milliseconds{100}, error);
+      CHECK(error == std::errc::timed_out);
+      CHECK(!client.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("the error of the last attempt is reported when every attempt fails")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      auto addresses = array{closed_address, closed_address};
+      auto error = std::error_code{};
+
+      co_await client.connect_any(addresses, chrono::seconds{5}, error);
+      CHECK(error == std::errc::connection_refused);
+      CHECK(!client.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
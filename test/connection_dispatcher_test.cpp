@@ -0,0 +1,106 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/socket/connection_dispatcher.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+#include "xynet/coroutine/async_scope.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <latch>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("connection_dispatcher" * doctest::timeout(10.0))
+{
+  // an io_service belongs to the thread that constructs it.
+  auto workers = array<io_service*, 2>{};
+  auto ready = latch{workers.size()};
+  auto threads = vector<jthread>{};
+  for(auto i = size_t{}; i < workers.size(); ++i)
+  {
+    threads.emplace_back([&workers, &ready, i](stop_token token)
+    {
+      auto worker = io_service{};
+      auto wake = stop_callback{token, [&worker]{ worker.request_stop(); }};
+      workers[i] = &worker;
+      ready.count_down();
+      worker.run(token);
+    });
+  }
+  ready.wait();
+
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto dispatcher = connection_dispatcher{workers};
+  auto served_on = array<io_service*, 4>{};
+
+  auto test = [&]() -> task<>
+  {
+    auto scope = async_scope{};
+    auto clients = array<socket_t, 4>{};
+    for(auto i = size_t{}; i < clients.size(); ++i)
+    {
+      clients[i].init();
+      auto peer = socket_t{};
+      co_await when_all(clients[i].connect(address), listen_socket.accept(peer));
+      dispatcher.dispatch(scope, std::move(peer), [&served_on, i](socket_t peer) -> task<>
+      {
+        served_on[i] = io_service::get_thread_io_service();
+        array<char, 1> buf{};
+        auto error = std::error_code{};
+        co_await peer.recv(error, buf);
+      });
+    }
+
+    // equally loaded workers take turns.
+    CHECK_EQ(dispatcher.active_connections(0), 2);
+    CHECK_EQ(dispatcher.active_connections(1), 2);
+
+    for(auto& client : clients)
+    {
+      client.shutdown();
+    }
+    co_await scope.join();
+    // join() resumes on the thread of the last connection served.
+    co_await service.schedule();
+
+    CHECK(served_on == array{workers[0], workers[1], workers[0], workers[1]});
+    CHECK_EQ(dispatcher.active_connections(0), 0);
+    CHECK_EQ(dispatcher.active_connections(1), 0);
+    CHECK_EQ(dispatcher.pick(), 0);
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
+
+TEST_CASE("connection_dispatcher: arguments and ties")
+{
+  CHECK_THROWS_AS(connection_dispatcher{span<io_service* const>{}}, const std::invalid_argument&);
+
+  // idle loops lag less than dispatch_loop_lag_granularity, so the workers take turns.
+  auto a = io_service{};
+  auto b = io_service{};
+  auto services = array<io_service*, 2>{&a, &b};
+  auto dispatcher = connection_dispatcher{services, dispatch_policy::lowest_loop_lag};
+  CHECK_EQ(dispatcher.pick(), 0);
+  CHECK_EQ(dispatcher.pick(), 1);
+  CHECK_EQ(dispatcher.pick(), 0);
+}
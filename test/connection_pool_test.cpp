@@ -0,0 +1,113 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/socket/connection_pool.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <stop_token>
+#include <vector>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto accept_n(socket_t& listen_socket, vector<socket_t>& peers, size_t n) -> task<>
+{
+  for(auto i = size_t{}; i < n; ++i)
+  {
+    auto peer = socket_t{};
+    co_await listen_socket.accept(peer);
+    peers.push_back(std::move(peer));
+  }
+}
+
+}
+
+TEST_CASE("connection_pool" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+  auto peers = vector<socket_t>{};
+
+  SUBCASE("acquire / release / reap")
+  {
+    auto pool = connection_pool<>{service, {.max_connections = 2, .idle_timeout = chrono::milliseconds{0}}};
+
+    auto test = [&]() -> task<>
+    {
+      auto [c1, c2, _] = co_await when_all(pool.acquire(address), pool.acquire(address),
+                                           accept_n(listen_socket, peers, 2));
+      CHECK(c1);
+      CHECK(c2);
+      CHECK(pool.connections(address) == 2);
+      auto fd = c1->get();
+
+      // the pool is full, the third acquire waits for c1.
+      auto third = [&]() -> task<int>
+      {
+        auto c = co_await pool.acquire(address);
+        co_return c->get();
+      };
+      auto releaser = [&]() -> task<>
+      {
+        co_await service.schedule(chrono::milliseconds{10});
+        c1.release();
+      };
+      auto [reused_fd, __] = co_await when_all(third(), releaser());
+      CHECK(reused_fd == fd);
+      CHECK(pool.connections(address) == 2);
+      CHECK(pool.idle_connections(address) == 1);
+
+      c2.discard();
+      c2.release();
+      CHECK(pool.connections(address) == 1);
+
+      CHECK(pool.reap_idle() == 1);
+      CHECK(pool.connections(address) == 0);
+      CHECK(pool.idle_connections(address) == 0);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("prewarm / dead idle connections")
+  {
+    auto pool = connection_pool<>{service};
+
+    auto test = [&]() -> task<>
+    {
+      auto [opened, _] = co_await when_all(pool.prewarm(address, 2), accept_n(listen_socket, peers, 2));
+      CHECK(opened == 2);
+      CHECK(pool.idle_connections(address) == 2);
+
+      // the backend closes both idle connections.
+      peers.clear();
+      co_await service.schedule(chrono::milliseconds{10});
+
+      auto [c, __] = co_await when_all(pool.acquire(address), accept_n(listen_socket, peers, 1));
+      CHECK(c);
+      CHECK(pool.connections(address) == 1);
+      CHECK(pool.idle_connections(address) == 0);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,191 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <stop_token>
+#include <string_view>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto bind_udp_socket()
+{
+  auto s = udp_socket_t{};
+  s.init();
+  s.bind(socket_address{"127.0.0.1", 0});
+  return s;
+}
+
+}
+
+TEST_CASE("udp socket" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+  auto receiver = bind_udp_socket();
+  auto sender = bind_udp_socket();
+
+  SUBCASE("send_to / recv_from")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto msg = string_view{"xynet"};
+      auto sent_bytes = co_await sender.send_to(receiver.get_local_address(), span{msg.data(), msg.size()});
+      CHECK(sent_bytes == msg.size());
+
+      array<char, 16> buf{};
+      auto from = socket_address{};
+      auto [bytes, segment_size] = co_await receiver.recv_from(from, buf);
+      CHECK(bytes == msg.size());
+      CHECK(segment_size == 0);
+      CHECK(string_view{buf.data(), bytes} == msg);
+      CHECK(from.port() == sender.get_local_address().port());
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("recv_from timeout")
+  {
+    auto test = [&]() -> task<>
+    {
+      array<char, 16> buf{};
+      auto from = socket_address{};
+      auto error = std::error_code{};
+      [[maybe_unused]]
+      auto result = co_await receiver.recv_from(chrono::milliseconds{50}, error, from, buf);
+      CHECK(error == std::errc::operation_canceled);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("send_batch / recv_batch")
+  {
+    constexpr auto count = 16;
+
+    auto test = [&]() -> task<>
+    {
+      auto messages = vector<string>{};
+      messages.reserve(count);
+      auto send_batch = datagram_batch{};
+      for(auto i = 0; i < count; ++i)
+      {
+        messages.push_back("datagram " + to_string(i));
+        send_batch.push(receiver.get_local_address(), span{messages.back().data(), messages.back().size()});
+      }
+
+      auto sent = co_await sender.send_batch(send_batch);
+      CHECK(sent == count);
+      CHECK(send_batch.bytes(0) == messages[0].size());
+
+      auto buffers = vector<array<char, 64>>(count);
+      auto recv_batch = datagram_batch{};
+      for(auto& buf : buffers)
+      {
+        recv_batch.prepare(buf);
+      }
+
+      auto received = std::size_t{};
+      while(received < count)
+      {
+        auto error = std::error_code{};
+        auto n = co_await receiver.recv_batch(recv_batch, error);
+        REQUIRE(!error);
+        for(auto i = std::size_t{}; i < n; ++i)
+        {
+          CHECK(string_view{buffers[i].data(), recv_batch.bytes(i)} == messages[received + i]);
+          CHECK(recv_batch.address(i).port() == sender.get_local_address().port());
+        }
+        received += n;
+      }
+      CHECK(received == count);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("send_batch: an error after a partial send")
+  {
+    auto test = [&]() -> task<>
+    {
+      // larger than a udp datagram can be, sendmsg(2) fails with EMSGSIZE.
+      auto small = string{"small"};
+      auto huge = string(70000, 'x');
+      auto batch = datagram_batch{};
+      batch.push(receiver.get_local_address(), span{small.data(), small.size()});
+      batch.push(receiver.get_local_address(), span{huge.data(), huge.size()});
+      batch.push(receiver.get_local_address(), span{small.data(), small.size()});
+
+      auto error = std::error_code{};
+      auto sent = co_await sender.send_batch(batch, error);
+      CHECK(!error);
+      CHECK(sent == 1);
+
+      auto only_huge = datagram_batch{};
+      only_huge.push(receiver.get_local_address(), span{huge.data(), huge.size()});
+      sent = co_await sender.send_batch(only_huge, error);
+      CHECK(error == std::errc::message_size);
+      CHECK(sent == 0);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("gso / gro")
+  {
+    constexpr auto segment = 100;
+    constexpr auto segments = 8;
+
+    auto test = [&]() -> task<>
+    {
+      auto error = std::error_code{};
+      receiver.udp_gro(true, error);
+      sender.udp_segment(segment, error);
+      if(error)
+      {
+        // the kernel does not support UDP GSO.
+        source.request_stop();
+        co_return;
+      }
+
+      auto msg = vector<char>(segment * segments, 'x');
+      auto sent_bytes = co_await sender.send_to(receiver.get_local_address(), msg);
+      CHECK(sent_bytes == msg.size());
+
+      auto buf = vector<char>(64 * 1024);
+      auto received = std::size_t{};
+      while(received < msg.size())
+      {
+        auto from = socket_address{};
+        auto [bytes, segment_size] = co_await receiver.recv_from(from, buf);
+        CHECK((segment_size == 0 || segment_size == segment));
+        CHECK(bytes % segment == 0);
+        received += bytes;
+      }
+      CHECK(received == msg.size());
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,97 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/socket/deadline.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <chrono>
+#include <stop_token>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("deadline_list" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+
+  SUBCASE("sweep")
+  {
+    auto list = deadline_list{service, chrono::milliseconds{100}};
+    auto start = list.now();
+    auto idle = connection_deadline{list, -1};
+    auto active = connection_deadline{list, -1};
+    auto disarmed = connection_deadline{list, -1};
+    disarmed.disarm();
+    CHECK(list.size() == 2);
+
+    CHECK(list.sweep(start + chrono::milliseconds{50}) == 0);
+    active.refresh();
+
+    CHECK(list.sweep(start + chrono::milliseconds{100}) == 1);
+    CHECK(idle.expired());
+    CHECK(!idle.armed());
+    CHECK(!active.expired());
+    CHECK(!disarmed.expired());
+    CHECK(list.size() == 1);
+
+    // active was refreshed at 50ms.
+    CHECK(list.sweep(start + chrono::milliseconds{149}) == 0);
+    CHECK(list.sweep(start + chrono::milliseconds{150}) == 1);
+    CHECK(active.expired());
+
+    idle.refresh();
+    CHECK(idle.armed());
+    CHECK(!idle.expired());
+    CHECK(list.size() == 1);
+  }
+
+  SUBCASE("an idle connection is canceled")
+  {
+    auto source = stop_source{};
+    auto listen_socket = socket_t{};
+    listen_socket.init();
+    listen_socket.bind(socket_address{"127.0.0.1", 0});
+    listen_socket.listen();
+
+    auto client = socket_t{};
+    auto peer = socket_t{};
+    client.init();
+
+    auto list = deadline_list{service, chrono::milliseconds{50}, chrono::milliseconds{10}};
+
+    auto list_source = stop_source{};
+    auto body = [&]() -> task<>
+    {
+      co_await when_all(client.connect(listen_socket.get_local_address()), listen_socket.accept(peer));
+
+      auto deadline = connection_deadline{list, peer};
+      array<char, 4> buf{};
+      auto error = std::error_code{};
+
+      co_await client.send(span{"ping", 4});
+      co_await peer.recv(error, buf);
+      CHECK(!error);
+      deadline.refresh();
+
+      co_await peer.recv_some(error, buf);
+      CHECK(error == std::errc::operation_canceled);
+      CHECK(deadline.expired());
+      list_source.request_stop();
+    };
+
+    auto test = [&]() -> task<>
+    {
+      co_await when_all(body(), list.run(list_source.get_token()));
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,277 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/file/file.h"
+#include "xynet/file/send_file.h"
+#include "xynet/file/recv_to_file.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <stop_token>
+#include <string>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto make_temp_file(const string& content)
+{
+  auto path = filesystem::temp_directory_path() / ("xynet_file_test_" + to_string(::getpid()));
+  auto out = ofstream{path, ios::binary};
+  out.write(content.data(), static_cast<streamsize>(content.size()));
+  return path;
+}
+
+auto read_whole_file(const filesystem::path& path)
+{
+  auto in = ifstream{path, ios::binary};
+  return string{istreambuf_iterator<char>{in}, istreambuf_iterator<char>{}};
+}
+
+auto connected_pair(socket_t& listen_socket) -> task<pair<socket_t, socket_t>>
+{
+  auto client = socket_t{};
+  auto peer = socket_t{};
+  client.init();
+  co_await when_all(
+    client.connect(listen_socket.get_local_address()),
+    listen_socket.accept(peer)
+  );
+  co_return pair{std::move(client), std::move(peer)};
+}
+
+}
+
+TEST_CASE("file" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto content = string{};
+  for(auto i = 0; content.size() < 1024 * 1024; ++i)
+  {
+    content += to_string(i) + ",";
+  }
+  auto path = make_temp_file(content);
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+
+  SUBCASE("openat / statx / read_some_offset")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto file = file_t{};
+      co_await file.openat(path, O_RDONLY, 0u);
+      co_await file.update_statx();
+      CHECK(file.file_size() == content.size());
+
+      auto buf = string(16, '\0');
+      auto bytes = co_await file.read_some_offset(100, span{buf});
+      CHECK(bytes == buf.size());
+      CHECK(buf == content.substr(100, 16));
+
+      auto error = std::error_code{};
+      auto missing = file_t{};
+      co_await missing.openat(path.string() + ".missing", O_RDONLY, 0u, error);
+      CHECK(error == std::errc::no_such_file_or_directory);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("send_file")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto file = file_t{};
+      co_await file.openat(path, O_RDONLY, 0u);
+
+      constexpr auto offset = 1000;
+      auto len = content.size() - offset - 10;
+
+      auto sender = [&]() -> task<size_t>
+      {
+        co_return co_await send_file(file, a, offset, len);
+      };
+      auto receiver = [&]() -> task<string>
+      {
+        auto buf = string(len, '\0');
+        co_await b.recv(span{buf});
+        co_return buf;
+      };
+
+      auto [sent, received] = co_await when_all(sender(), receiver());
+      CHECK(sent == len);
+      CHECK(received == content.substr(offset, len));
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("send_file: buffered")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto file = file_t{};
+      co_await file.openat(path, O_RDONLY, 0u);
+
+      auto sender = [&]() -> task<size_t>
+      {
+        auto error = std::error_code{};
+        // ask for more than the file has, the transfer stops at the end of the file.
+        auto sent = co_await detail::send_file_buffered(file, a, 0, content.size() * 2, error);
+        CHECK(!error);
+        a.shutdown();
+        co_return sent;
+      };
+      auto receiver = [&]() -> task<string>
+      {
+        auto buf = string(content.size(), '\0');
+        co_await b.recv(span{buf});
+        co_return buf;
+      };
+
+      auto [sent, received] = co_await when_all(sender(), receiver());
+      CHECK(sent == content.size());
+      CHECK(received == content);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("write_offset")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto out_path = path.string() + ".out";
+      auto file = file_t{};
+      co_await file.openat(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0600u);
+      auto written = co_await file.write_offset(4, span{"xynet", 5});
+      CHECK(written == 5);
+      written = co_await file.write_some_offset(0, span{"1234", 4});
+      CHECK(written == 4);
+      CHECK(read_whole_file(out_path) == "1234xynet");
+      filesystem::remove(out_path);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("recv_to_file")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto out_path = path.string() + ".out";
+      auto file = file_t{};
+      co_await file.openat(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0600u);
+
+      auto sender = [&]() -> task<>
+      {
+        co_await a.send(span{content});
+        a.shutdown();
+      };
+      auto receiver = [&]() -> task<size_t>
+      {
+        // ask for more than the peer sends, the transfer stops at EOF.
+        co_return co_await recv_to_file(b, file, 3, content.size() * 2);
+      };
+
+      auto [_, received] = co_await when_all(sender(), receiver());
+      CHECK(received == content.size());
+      CHECK(read_whole_file(out_path) == string(3, '\0') + content);
+      filesystem::remove(out_path);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("recv_to_file: the file rejects splice")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto out_path = path.string() + ".out";
+      auto file = file_t{};
+      // splice(2) fails with EINVAL for a file opened with O_APPEND.
+      co_await file.openat(out_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0600u);
+
+      auto sender = [&]() -> task<>
+      {
+        co_await a.send(span{content});
+        a.shutdown();
+      };
+      auto receiver = [&]() -> task<size_t>
+      {
+        co_return co_await recv_to_file(b, file, 0, content.size() * 2);
+      };
+
+      auto [_, received] = co_await when_all(sender(), receiver());
+      CHECK(received == content.size());
+      CHECK(read_whole_file(out_path) == content);
+      filesystem::remove(out_path);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("recv_to_file: buffered")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto out_path = path.string() + ".out";
+      auto file = file_t{};
+      co_await file.openat(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0600u);
+
+      auto sender = [&]() -> task<>
+      {
+        co_await a.send(span{content});
+      };
+      auto receiver = [&]() -> task<size_t>
+      {
+        auto error = std::error_code{};
+        auto received = co_await detail::recv_to_file_buffered(b, file, 0, content.size(), error);
+        CHECK(!error);
+        co_return received;
+      };
+
+      auto [_, received] = co_await when_all(sender(), receiver());
+      CHECK(received == content.size());
+      CHECK(read_whole_file(out_path) == content);
+      filesystem::remove(out_path);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  filesystem::remove(path);
+}
@@ -0,0 +1,163 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/iobuf.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <algorithm>
+#include <stop_token>
+#include <vector>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto write(iobuf& buf, std::size_t n, std::size_t& next)
+{
+  auto span = buf.prepare(n);
+  for(auto& b : span)
+  {
+    b = static_cast<std::byte>(next++ % 251);
+  }
+  buf.commit(n);
+}
+
+auto contents(const iobuf& buf) -> vector<std::byte>
+{
+  auto bytes = vector<std::byte>(buf.size());
+  CHECK_EQ(buf.copy_to(bytes), buf.size());
+  return bytes;
+}
+
+auto sequence(std::size_t first, std::size_t n) -> vector<std::byte>
+{
+  auto bytes = vector<std::byte>(n);
+  for(auto& b : bytes)
+  {
+    b = static_cast<std::byte>(first++ % 251);
+  }
+  return bytes;
+}
+
+}
+
+TEST_CASE("iobuf")
+{
+  auto buf = iobuf{1000};
+  auto next = std::size_t{};
+
+  SUBCASE("prepare writes after the last segment while it has room")
+  {
+    write(buf, 300, next);
+    write(buf, 300, next);
+    CHECK_EQ(buf.segment_count(), 1);
+    write(buf, 600, next);
+    CHECK_EQ(buf.segment_count(), 2);
+    CHECK_EQ(buf.size(), 1200);
+    CHECK_EQ(buf.front().size(), 600);
+    CHECK_EQ(contents(buf), sequence(0, 1200));
+  }
+
+  SUBCASE("consume drops the segments that have been read without moving the rest")
+  {
+    write(buf, 1000, next);
+    write(buf, 1000, next);
+    auto* second = std::next(buf.begin())->data();
+    buf.consume(1100);
+    CHECK_EQ(buf.segment_count(), 1);
+    CHECK_EQ(buf.front().data(), second + 100);
+    CHECK_EQ(contents(buf), sequence(1100, 900));
+
+    // the last segment is written to again from its start.
+    auto* start = second;
+    buf.consume(900);
+    CHECK(buf.empty());
+    CHECK_EQ(buf.prepare(10).data(), start);
+  }
+
+  SUBCASE("split shares the segment on the boundary")
+  {
+    write(buf, 1000, next);
+    write(buf, 1000, next);
+    auto head = buf.split(1500);
+    CHECK_EQ(head.size(), 1500);
+    CHECK_EQ(buf.size(), 500);
+    CHECK_EQ(head.segment_count(), 2);
+    CHECK_EQ(std::next(head.begin())->end(), buf.front().data());
+    CHECK_EQ(contents(head), sequence(0, 1500));
+    CHECK_EQ(contents(buf), sequence(1500, 500));
+
+    // the shared segment is not written to.
+    write(buf, 10, next);
+    CHECK_EQ(buf.segment_count(), 2);
+    CHECK_EQ(contents(buf), sequence(1500, 510));
+    CHECK_EQ(contents(head), sequence(0, 1500));
+  }
+
+  SUBCASE("append and trim_back")
+  {
+    write(buf, 100, next);
+    auto received = buffer_pool::local().allocate(200);
+    std::ranges::copy(sequence(100, 200), received.begin());
+    auto* data = received.data();
+    buf.append(std::move(received));
+    CHECK_EQ(std::next(buf.begin())->data(), data);
+
+    auto other = iobuf{};
+    write(other, 50, next = 300);
+    buf.append(std::move(other));
+    CHECK(other.empty());
+    CHECK_EQ(buf.segment_count(), 3);
+    CHECK_EQ(contents(buf), sequence(0, 350));
+
+    buf.trim_back(60);
+    CHECK_EQ(buf.segment_count(), 2);
+    CHECK_EQ(contents(buf), sequence(0, 290));
+  }
+}
+
+TEST_CASE("send an iobuf" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto test = [&]() -> task<>
+  {
+    auto client = socket_t{};
+    auto peer = socket_t{};
+    client.init();
+    co_await when_all(client.connect(address), listen_socket.accept(peer));
+
+    auto buf = iobuf{256};
+    auto next = std::size_t{};
+    for(auto i = 0; i < 4; ++i)
+    {
+      write(buf, 256, next);
+    }
+    buf.consume(100);
+    CHECK_EQ(buf.segment_count(), 4);
+    auto sent = co_await client.send(buf);
+    CHECK_EQ(sent, 924);
+
+    auto received = vector<std::byte>(924);
+    co_await peer.recv(received);
+    CHECK_EQ(received, sequence(100, 924));
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
@@ -0,0 +1,90 @@
+#include "doctest/doctest.h"
+
+#include "xynet/mirrored_ring_buffer.h"
+#include "xynet/http/http_parser.h"
+
+#include <algorithm>
+#include <string_view>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto write(mirrored_ring_buffer& ring, string_view str)
+{
+  auto span = ring.prepare(str.size());
+  REQUIRE_EQ(span.size(), str.size());
+  std::ranges::copy(as_bytes(std::span{str}), span.begin());
+  ring.commit(str.size());
+}
+
+}
+
+TEST_CASE("mirrored_ring_buffer")
+{
+  auto ring = mirrored_ring_buffer{1000};
+  auto capacity = ring.capacity();
+  CHECK_GE(capacity, 1000);
+  CHECK_EQ(capacity % static_cast<size_t>(::sysconf(_SC_PAGESIZE)), 0);
+
+  // leave the read position 10 bytes before the end of the ring.
+  ring.commit(capacity - 10);
+  ring.consume(capacity - 10);
+  CHECK_EQ(ring.size(), 0);
+
+  SUBCASE("the readable bytes are contiguous across the wrap point")
+  {
+    write(ring, "0123456789abcdefghij");
+    CHECK_EQ(ring.data_string_view(), "0123456789abcdefghij");
+    CHECK_EQ(ring.data().size(), 20);
+
+    ring.consume(15);
+    CHECK_EQ(ring.data_string_view(), "fghij");
+    write(ring, "klm");
+    CHECK_EQ(ring.data_string_view(), "fghijklm");
+  }
+
+  SUBCASE("prepare returns at most the free bytes")
+  {
+    write(ring, "abc");
+    CHECK_EQ(ring.prepare(capacity).size(), capacity - 3);
+    ring.commit(capacity);
+    CHECK_EQ(ring.size(), capacity);
+    CHECK(ring.prepare(1).empty());
+    CHECK_EQ(ring.data_string_view().substr(0, 3), "abc");
+  }
+
+  SUBCASE("an http request parsed across the wrap point")
+  {
+    constexpr auto request = "GET /chat HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n\r\n"sv;
+    auto parser = http_parser{};
+    write(ring, request.substr(0, 7));
+    CHECK_EQ(parser.parse(ring.data()), -2);
+    write(ring, request.substr(7));
+    CHECK_EQ(parser.parse(ring.data()), static_cast<int>(request.size()));
+    CHECK_EQ(parser.method(), "GET");
+    CHECK_EQ(parser.path(), "/chat");
+    CHECK_EQ(std::ranges::distance(parser.headers()), 2);
+  }
+
+  SUBCASE("moved")
+  {
+    write(ring, "abc");
+    auto other = std::move(ring);
+    CHECK_EQ(other.data_string_view(), "abc");
+    CHECK_EQ(other.capacity(), capacity);
+  }
+}
+
+TEST_CASE("mirrored_ring_buffer with huge pages")
+{
+  // backed by regular pages if there are no huge pages.
+  auto ring = mirrored_ring_buffer{1000, true};
+  CHECK_EQ(ring.capacity() % (ring.huge_pages() ? mirrored_ring_buffer::huge_page_size : 4096), 0);
+  ring.commit(ring.capacity() - 1);
+  ring.consume(ring.capacity() - 1);
+  write(ring, "xy");
+  CHECK_EQ(ring.data_string_view(), "xy");
+}
@@ -0,0 +1,83 @@
+#include "doctest/doctest.h"
+
+#include "xynet/object_slab.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+struct record_t
+{
+  record_t(int id, int& alive)
+  :m_id{id}
+  ,m_alive{alive}
+  {
+    if(id < 0)
+    {
+      throw std::invalid_argument{"id"};
+    }
+    ++m_alive;
+  }
+
+  ~record_t()
+  {
+    --m_alive;
+  }
+
+  int m_id;
+  int& m_alive;
+  char m_buffer[100];
+};
+
+}
+
+TEST_CASE("object_slab")
+{
+  auto alive = 0;
+  auto slab = object_slab<record_t>{2};
+  CHECK(slab.capacity() == 2);
+  CHECK(object_slab<record_t>::record_size % cache_line_size == 0);
+  CHECK(object_slab<record_t>::record_size >= sizeof(record_t));
+
+  auto a = slab.try_make(1, alive);
+  auto b = slab.try_make(2, alive);
+  REQUIRE(a);
+  REQUIRE(b);
+  CHECK(a->m_id == 1);
+  CHECK(b->m_id == 2);
+  CHECK(reinterpret_cast<std::uintptr_t>(a.get()) % cache_line_size == 0);
+  CHECK(alive == 2);
+  CHECK(slab.available() == 0);
+
+  SUBCASE("full")
+  {
+    CHECK(!slab.try_make(3, alive));
+    CHECK_THROWS_AS((void)slab.make(3, alive), const std::bad_alloc&);
+    CHECK(alive == 2);
+  }
+
+  SUBCASE("a released record is reused")
+  {
+    auto* address = a.get();
+    a.reset();
+    CHECK(alive == 1);
+    CHECK(slab.size() == 1);
+    auto c = slab.make(3, alive);
+    CHECK(c.get() == address);
+    CHECK(c->m_id == 3);
+  }
+
+  SUBCASE("a throwing constructor returns the record")
+  {
+    b.reset();
+    CHECK_THROWS_AS((void)slab.make(-1, alive), const std::invalid_argument&);
+    CHECK(slab.size() == 1);
+    CHECK(slab.try_make(4, alive));
+  }
+}
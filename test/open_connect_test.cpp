@@ -0,0 +1,111 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <stop_token>
+#include <netinet/tcp.h>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto get_int_option(const socket_t& socket, int level, int name) -> int
+{
+  int value = 0;
+  auto len = static_cast<socklen_t>(sizeof(value));
+  ::getsockopt(socket.get(), level, name, &value, &len);
+  return value;
+}
+
+}
+
+TEST_CASE("open_connect" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  SUBCASE("async_init creates the socket")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      co_await client.async_init();
+      CHECK(client.valid());
+
+      auto peer = socket_t{};
+      co_await when_all(client.connect(address), listen_socket.accept(peer));
+      CHECK(peer.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("open_connect applies the profile before connecting")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto client = socket_t{};
+      auto peer = socket_t{};
+      auto profile = socket_profile{};
+      profile.no_delay   = true;
+      profile.keep_alive = keep_alive_settings{};
+      co_await when_all(client.open_connect(address, profile), listen_socket.accept(peer));
+
+      REQUIRE(client.valid());
+      CHECK(get_int_option(client, IPPROTO_TCP, TCP_NODELAY) != 0);
+      CHECK(get_int_option(client, SOL_SOCKET, SO_KEEPALIVE) != 0);
+      CHECK(client.get_peer_address().port() == address.port());
+
+      // the fd is a regular one, usable by every other operation.
+      auto buf = std::array<char, 4>{'p', 'i', 'n', 'g'};
+      auto received = std::array<char, 4>{};
+      co_await client.send(buf);
+      co_await peer.recv(received);
+      CHECK(received == buf);
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("open_connect to a closed port reports the error and leaves the socket closed")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto closed_address = socket_address{};
+      {
+        auto closed = socket_t{};
+        closed.init();
+        closed.bind(socket_address{"127.0.0.1", 0});
+        closed_address = closed.get_local_address();
+      }
+
+      auto client = socket_t{};
+      auto profile = socket_profile{};
+      profile.no_delay = true;
+      auto error = std::error_code{};
+      co_await client.open_connect(closed_address, profile, error);
+      CHECK(error == std::errc::connection_refused);
+      CHECK(!client.valid());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,130 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/socket/read_until.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <random>
+#include <stop_token>
+#include <string>
+#include <string_view>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto to_string_view(span<const byte> bytes) -> string_view
+{
+  return string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+}
+
+TEST_CASE("find_delimiter")
+{
+  auto gen = mt19937{42};
+  // few distinct bytes, so that partial matches of the delimiters are common.
+  auto dis = uniform_int_distribution<>{0, 3};
+  auto alphabet = "\r\nab"sv;
+
+  for(auto delimiter : {"\n"sv, "\r\n"sv, "\r\n\r\n"sv, "ab\nba"sv})
+  {
+    for(auto size = size_t{}; size < 200; ++size)
+    {
+      auto text = string(size, '\0');
+      for(auto& c : text)
+      {
+        c = alphabet[dis(gen)];
+      }
+      for(auto offset = size_t{}; offset < std::min<size_t>(size, 3); ++offset)
+      {
+        auto first = text.data() + offset;
+        auto last  = text.data() + text.size();
+        auto found = detail::find_delimiter(first, last, delimiter);
+        CHECK_EQ(found, detail::find_delimiter_scalar(first, last, delimiter));
+#if defined(__x86_64__)
+        if(last - first >= static_cast<ptrdiff_t>(delimiter.size()))
+        {
+          CHECK_EQ(detail::find_delimiter_sse2(first, last, delimiter), found);
+        }
+#endif
+      }
+    }
+  }
+
+  auto text = string(100, 'x') + "\r\n\r\n";
+  CHECK_EQ(detail::find_delimiter(text.data(), text.data() + text.size(), "\r\n\r\n"), text.data() + 100);
+  CHECK_EQ(detail::find_delimiter(text.data(), text.data() + 101, "\r\n"), text.data() + 101);
+}
+
+TEST_CASE("read_until" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto test = [&]() -> task<>
+  {
+    auto client = socket_t{};
+    auto peer = socket_t{};
+    client.init();
+    co_await when_all(client.connect(address), listen_socket.accept(peer));
+
+    auto buffer = stream_buffer{};
+    auto long_line = string(10000, 'x') + "\n";
+    auto too_long  = string(200, 'y');
+
+    // the delimiter is split across two sends.
+    co_await client.send(span{"GET / HTTP/1.1\r\nHost: x\r\n\r"sv});
+    auto reader = [&]() -> task<>
+    {
+      auto request = co_await read_until(peer, buffer, "\r\n\r\n");
+      CHECK_EQ(to_string_view(request), "GET / HTTP/1.1\r\nHost: x\r\n\r\n");
+      buffer.consume(request.size());
+
+      // the line after the delimiter was received by the same recv.
+      auto line = co_await read_until(peer, buffer, "\n");
+      CHECK_EQ(to_string_view(line), "first\n");
+      buffer.consume(line.size());
+
+      line = co_await read_until(peer, buffer, "\n");
+      CHECK_EQ(to_string_view(line), long_line);
+      buffer.consume(line.size());
+
+      auto error = std::error_code{};
+      line = co_await read_until(peer, buffer, "\n", 100, error);
+      CHECK(error == std::errc::message_size);
+      CHECK(line.empty());
+      CHECK_GE(buffer.size(), 100);
+
+      buffer.consume(buffer.size());
+      line = co_await read_until(peer, buffer, "\n", error);
+      CHECK(error);
+      CHECK(line.empty());
+    };
+    auto writer = [&]() -> task<>
+    {
+      co_await client.send(span{"\nfirst\n"sv});
+      co_await client.send(span{long_line});
+      co_await client.send(span{too_long});
+      client.shutdown();
+    };
+    co_await when_all(reader(), writer());
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
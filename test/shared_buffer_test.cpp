@@ -0,0 +1,127 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/shared_buffer.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto to_string_view(const shared_buffer& buffer) -> string_view
+{
+  return string_view{reinterpret_cast<const char*>(buffer.data()), buffer.size()};
+}
+
+}
+
+TEST_CASE("shared_buffer")
+{
+  auto buffer = shared_buffer{as_bytes(span{"hello world"sv})};
+  CHECK_EQ(to_string_view(buffer), "hello world");
+  CHECK_EQ(buffer.use_count(), 1);
+
+  SUBCASE("copies and slices share the bytes")
+  {
+    auto copy = buffer;
+    auto world = buffer.slice(6);
+    auto ell = buffer.slice(1, 3);
+    CHECK_EQ(buffer.use_count(), 4);
+    CHECK_EQ(copy.data(), buffer.data());
+    CHECK_EQ(world.data(), buffer.data() + 6);
+    CHECK_EQ(to_string_view(world), "world");
+    CHECK_EQ(to_string_view(ell), "ell");
+    CHECK_EQ(to_string_view(world.slice(3, 100)), "ld");
+    CHECK(buffer.slice(100).empty());
+
+    buffer.reset();
+    CHECK(!buffer);
+    CHECK_EQ(copy.use_count(), 3);
+    copy = shared_buffer{};
+    CHECK_EQ(world.use_count(), 2);
+    CHECK_EQ(to_string_view(world), "world");
+  }
+
+  SUBCASE("filled through writable")
+  {
+    auto message = shared_buffer{3};
+    auto bytes = message.writable();
+    bytes[0] = byte{'a'};
+    bytes[1] = byte{'b'};
+    bytes[2] = byte{'c'};
+    CHECK_EQ(to_string_view(message), "abc");
+  }
+
+  SUBCASE("copied and released on other threads")
+  {
+    auto concurrent = shared_buffer{as_bytes(span{"shared"sv}), buffer_sharing::concurrent};
+    {
+      auto threads = vector<jthread>{};
+      for(auto i = 0; i < 4; ++i)
+      {
+        threads.emplace_back([&concurrent]()
+        {
+          for(auto n = 0; n < 10000; ++n)
+          {
+            [[maybe_unused]]
+            auto copy = concurrent;
+          }
+        });
+      }
+    }
+    CHECK_EQ(concurrent.use_count(), 1);
+  }
+}
+
+TEST_CASE("shared_buffer with send and send_queue" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+  auto address = listen_socket.get_local_address();
+
+  auto test = [&]() -> task<>
+  {
+    auto client = socket_t{};
+    auto peer = socket_t{};
+    client.init();
+    co_await when_all(client.connect(address), listen_socket.accept(peer));
+
+    auto message = shared_buffer{as_bytes(span{"0123456789"sv})};
+    {
+      auto parts = vector<shared_buffer>{message.slice(5), message.slice(0, 5)};
+      co_await client.send(parts);
+    }
+
+    client.enqueue(message);
+    client.enqueue(message.slice(8));
+    CHECK_EQ(message.use_count(), 3);
+    co_await client.flush();
+    CHECK_EQ(message.use_count(), 1);
+
+    auto received = string(22, '\0');
+    co_await peer.recv(span{received});
+    CHECK_EQ(received, "5678901234012345678989");
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
@@ -75,3 +75,14 @@ TEST_CASE("socket_address move assignment")
   CHECK_EQ(move_addr.to_str(), "123.123.123.123:80");
 }
 
+
+TEST_CASE("socket_address comparison")
+{
+  auto addr = socket_address{"127.0.0.1", 80};
+
+  CHECK(addr == socket_address{"127.0.0.1", 80});
+  CHECK(addr != socket_address{"127.0.0.1", 81});
+  CHECK(addr != socket_address{"127.0.0.2", 80});
+  CHECK(std::is_lt(socket_address{"127.0.0.1", 80} <=> socket_address{"127.0.0.1", 81}));
+  CHECK(std::is_gt(socket_address{"127.0.0.1", 81} <=> socket_address{"127.0.0.1", 80}));
+}
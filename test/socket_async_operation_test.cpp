@@ -15,6 +15,8 @@
 #include "xynet/socket/impl/recv_all.h"
 #include "xynet/socket/impl/close.h"
 #include "xynet/socket/impl/send_all.h"
+#include "xynet/socket/impl/send_zc.h"
+#include "xynet/socket/impl/send_queue.h"
 
 #include "xynet/io_service.h"
 
@@ -25,6 +27,7 @@
 
 #include <stop_token>
 #include <random>
+#include <algorithm>
 
 using namespace xynet;
 using namespace std;
@@ -43,7 +46,9 @@ using socket_t = file_descriptor
     operation_connect,
     operation_close,
     operation_recv,
-    operation_send
+    operation_send,
+    operation_send_zc,
+    operation_send_queue
   >
 >;
 
@@ -157,6 +162,46 @@ TEST_CASE("send / recv" * doctest::timeout(10.0))
     ));
   }
 
+  SUBCASE("send and recv moved into when_all")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    auto msg = vector<vector<char>>{{'x', 'y'}, {'n', 'e', 't'}};
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      array<char, 5> reply{};
+      auto [sent, received] = co_await when_all(s.send(msg), s.recv(reply));
+      CHECK_EQ(sent, 5);
+      CHECK_EQ(received, 5);
+      CHECK(string_view{reply.data(), reply.size()} == "xynet");
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      array<char, 5> buf{};
+      co_await s.recv(buf);
+      co_await s.send(buf);
+      co_await close_socket(s);
+    };
+
+    auto test_when_all = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_when_all(),
+      service_start(service, source.get_token())
+    ));
+  }
+
   SUBCASE("send/recv some bytes")
   {
     auto PORT = port_gen();
@@ -319,6 +364,244 @@ TEST_CASE("send / recv" * doctest::timeout(10.0))
     ));
   }
 
+  SUBCASE("send_zc/recv 1M bytes")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    auto msg = vector<char>(1024 * 1024);
+    for(auto i = size_t{}; i < msg.size(); ++i)
+    {
+      msg[i] = static_cast<char>(i % 251);
+    }
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      auto sent_bytes = size_t{};
+      REQUIRE_NOTHROW(sent_bytes = co_await s.send_zc(span{msg}));
+      CHECK(sent_bytes == msg.size());
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      auto buf = vector<char>(msg.size());
+      REQUIRE_NOTHROW(co_await s.recv(span{buf}));
+      CHECK(msg == buf);
+      co_await close_socket(s);
+    };
+
+    auto test_recv_send_0 = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_recv_send_0(),
+      service_start(service, source.get_token())
+    ));
+  }
+
+  SUBCASE("send_zc/recv some bytes")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    array<char, 5> msg{'x', 'y', 'n', 'e', 't'};
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      auto error = std::error_code{};
+      auto sent_bytes = co_await s.send_zc(error, msg);
+      CHECK(!error);
+      CHECK(sent_bytes == msg.size());
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      array<char, 5> buf{};
+      REQUIRE_NOTHROW(co_await s.recv(buf));
+      CHECK(msg == buf);
+      co_await close_socket(s);
+    };
+
+    auto test_recv_send_0 = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_recv_send_0(),
+      service_start(service, source.get_token())
+    ));
+  }
+
+  SUBCASE("send_zc and recv moved into when_all")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    // above send_zc_threshold, with the iovecs stored in the awaiter.
+    auto msg = vector<vector<char>>{vector<char>(32 * 1024, 'x'), vector<char>(32 * 1024, 'y')};
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      auto reply = vector<char>(64 * 1024);
+      auto [sent, received] = co_await when_all(s.send_zc(msg), s.recv(span{reply}));
+      CHECK_EQ(sent, reply.size());
+      CHECK_EQ(received, reply.size());
+      CHECK(equal(msg[0].begin(), msg[0].end(), reply.begin()));
+      CHECK(equal(msg[1].begin(), msg[1].end(), reply.begin() + 32 * 1024));
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      auto buf = vector<char>(64 * 1024);
+      co_await s.recv(span{buf});
+      co_await s.send(span{buf});
+      co_await close_socket(s);
+    };
+
+    auto test_when_all = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_when_all(),
+      service_start(service, source.get_token())
+    ));
+  }
+
+  SUBCASE("send_queue flush")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    auto expected = string{};
+    auto messages = vector<shared_ptr<string>>{};
+    for(auto i = 0; i < 100; ++i)
+    {
+      messages.push_back(make_shared<string>("message " + to_string(i) + "\n"));
+      expected += *messages.back();
+    }
+    const auto tail = string{"tail\n"};
+    expected += tail;
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      // nothing has been enqueued on the socket yet.
+      CHECK(s.send_queue_empty());
+      CHECK(co_await s.flush() == 0);
+
+      for(auto& message : messages)
+      {
+        s.enqueue(message);
+      }
+      s.enqueue(as_bytes(span{tail}));
+      CHECK(s.send_queue_bytes() == expected.size());
+      auto sent_bytes = size_t{};
+      REQUIRE_NOTHROW(sent_bytes = co_await s.flush());
+      CHECK(sent_bytes == expected.size());
+      CHECK(s.send_queue_empty());
+      CHECK(s.send_queue_bytes() == 0);
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      auto buf = string(expected.size(), '\0');
+      REQUIRE_NOTHROW(co_await s.recv(span{buf}));
+      CHECK(buf == expected);
+      co_await close_socket(s);
+    };
+
+    auto test_recv_send_0 = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_recv_send_0(),
+      service_start(service, source.get_token())
+    ));
+  }
+
+  SUBCASE("send_queue watermarks")
+  {
+    auto PORT = port_gen();
+    auto source = stop_source{};
+    auto msg = make_shared<vector<char>>(1024, 'x');
+
+    auto client = [&](socket_t s) -> task<>
+    {
+      s.set_send_queue_watermarks(512, 1024);
+      CHECK(s.writable().await_ready());
+      s.enqueue(msg);
+      CHECK(!s.writable().await_ready());
+
+      auto writable = false;
+      auto producer = [&]() -> task<>
+      {
+        co_await s.writable();
+        writable = true;
+        CHECK(s.send_queue_bytes() <= 512);
+      };
+      auto flusher = [&]() -> task<>
+      {
+        CHECK(!writable);
+        auto error = std::error_code{};
+        co_await s.flush(error);
+        CHECK(!error);
+      };
+
+      co_await when_all(producer(), flusher());
+      CHECK(writable);
+      co_await close_socket(s);
+    };
+
+    auto server = [&](socket_t s) -> task<>
+    {
+      auto buf = vector<char>(msg->size());
+      REQUIRE_NOTHROW(co_await s.recv(span{buf}));
+      CHECK(buf == *msg);
+      co_await close_socket(s);
+    };
+
+    auto test_recv_send_0 = [&]() -> task<>
+    {
+      co_await when_all(
+        connector(client, PORT),
+        acceptor(server, service, PORT)
+      );
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(
+      test_recv_send_0(),
+      service_start(service, source.get_token())
+    ));
+  }
+
   SUBCASE("recv timeout")
   {
     auto PORT = port_gen();
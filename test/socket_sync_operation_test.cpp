@@ -10,6 +10,10 @@
 #include "xynet/socket/impl/socket_init.h"
 #include "xynet/socket/impl/setsockopt.h"
 
+#include <array>
+#include <poll.h>
+#include <unistd.h>
+
 using namespace xynet;
 using namespace std;
 
@@ -82,6 +86,147 @@ TEST_CASE("socket sync operations test")
     CHECK(ret != 0);
   }
 
+  SUBCASE("typed options")
+  {
+    auto get_int_option = [&s](int level, int optname)
+    {
+      auto ret = int{};
+      auto len = socklen_t{sizeof(ret)};
+      ::getsockopt(s.get(), level, optname, &ret, &len);
+      return ret;
+    };
+
+    SUBCASE("reuse_port")
+    {
+      s.reuse_port();
+      CHECK(get_int_option(SOL_SOCKET, SO_REUSEPORT) != 0);
+    }
+
+    SUBCASE("no_delay")
+    {
+      s.no_delay();
+      CHECK(get_int_option(IPPROTO_TCP, TCP_NODELAY) != 0);
+      auto error = std::error_code{};
+      s.no_delay(false, error);
+      CHECK(!error);
+      CHECK(get_int_option(IPPROTO_TCP, TCP_NODELAY) == 0);
+    }
+
+    SUBCASE("buffer sizes")
+    {
+      s.receive_buffer_size(64 * 1024);
+      s.send_buffer_size(64 * 1024);
+      CHECK(get_int_option(SOL_SOCKET, SO_RCVBUF) >= 64 * 1024);
+      CHECK(get_int_option(SOL_SOCKET, SO_SNDBUF) >= 64 * 1024);
+    }
+
+    SUBCASE("keep_alive")
+    {
+      s.keep_alive(keep_alive_settings{
+        .idle = chrono::seconds{30},
+        .interval = chrono::seconds{5},
+        .count = 3});
+      CHECK(get_int_option(SOL_SOCKET, SO_KEEPALIVE) != 0);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_KEEPIDLE), 30);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_KEEPINTVL), 5);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_KEEPCNT), 3);
+    }
+
+    SUBCASE("reuse_port_cpu_steering")
+    {
+      auto other = socket_sync_t{};
+      other.init();
+      s.reuse_port();
+      other.reuse_port();
+      s.bind(socket_address{"127.0.0.1", 0});
+      other.bind(s.get_local_address());
+      s.listen();
+      other.listen();
+
+      auto error = std::error_code{};
+      s.reuse_port_cpu_steering(0, error);
+      CHECK(error);
+      s.reuse_port_cpu_steering(2);
+
+      // the connection goes to one listener of the group.
+      auto client = socket_sync_t{};
+      client.init();
+      auto address = s.get_local_address();
+      REQUIRE(::connect(client.get(), reinterpret_cast<const ::sockaddr*>(address.as_sockaddr_in()),
+                        sizeof(::sockaddr_in)) == 0);
+      auto fds = array{::pollfd{.fd = s.get(), .events = POLLIN}, ::pollfd{.fd = other.get(), .events = POLLIN}};
+      CHECK_EQ(::poll(fds.data(), fds.size(), 1000), 1);
+    }
+
+    SUBCASE("listener options")
+    {
+      s.defer_accept(chrono::seconds{5});
+      CHECK(get_int_option(IPPROTO_TCP, TCP_DEFER_ACCEPT) > 0);
+      s.fast_open(16);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_FASTOPEN), 16);
+    }
+
+    SUBCASE("not_sent_low_watermark")
+    {
+      s.not_sent_low_watermark(16 * 1024);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_NOTSENT_LOWAT), 16 * 1024);
+    }
+
+    SUBCASE("invalid value reports error")
+    {
+      auto error = std::error_code{};
+      s.keep_alive(keep_alive_settings{.idle = chrono::seconds{0}}, error);
+      CHECK(error);
+      REQUIRE_THROWS(s.keep_alive(keep_alive_settings{.idle = chrono::seconds{0}}));
+    }
+
+    SUBCASE("profiles")
+    {
+      s.apply_listener_profile(socket_profile::low_latency());
+      CHECK(get_int_option(SOL_SOCKET, SO_REUSEADDR) != 0);
+      CHECK(get_int_option(IPPROTO_TCP, TCP_NODELAY) != 0);
+      CHECK_EQ(get_int_option(IPPROTO_TCP, TCP_NOTSENT_LOWAT), 16 * 1024);
+
+      auto other = socket_sync_t{};
+      other.init();
+      other.apply_connection_profile(socket_profile::bulk());
+      auto ret = int{};
+      auto len = socklen_t{sizeof(ret)};
+      ::getsockopt(other.get(), SOL_SOCKET, SO_KEEPALIVE, &ret, &len);
+      CHECK(ret != 0);
+    }
+
+    SUBCASE("accepted sockets inherit the listener profile")
+    {
+      s.apply_listener_profile(socket_profile::low_latency());
+      s.bind(socket_address{"127.0.0.1", 0});
+      s.listen();
+
+      auto client = ::socket(AF_INET, SOCK_STREAM, 0);
+      REQUIRE(::connect(client, reinterpret_cast<const ::sockaddr*>(s.get_local_address().as_sockaddr_in()),
+                        sizeof(::sockaddr_in)) == 0);
+      auto peer = socket_sync_t{};
+      peer.set(::accept(s.get(), nullptr, nullptr));
+      REQUIRE(peer.get() >= 0);
+
+      auto get_peer_option = [&peer](int level, int name)
+      {
+        auto ret = int{};
+        auto len = socklen_t{sizeof(ret)};
+        ::getsockopt(peer.get(), level, name, &ret, &len);
+        return ret;
+      };
+      CHECK(get_peer_option(IPPROTO_TCP, TCP_NODELAY) != 0);
+      CHECK_EQ(get_peer_option(IPPROTO_TCP, TCP_NOTSENT_LOWAT), 16 * 1024);
+
+      auto error = std::error_code{};
+      peer.apply_accepted_profile(socket_profile::low_latency(), error);
+      CHECK(!error);
+      CHECK(get_peer_option(IPPROTO_TCP, TCP_QUICKACK) != 0);
+      ::close(client);
+    }
+  }
+
   SUBCASE("shutdown")
   {
     REQUIRE_THROWS(s.shutdown());
@@ -0,0 +1,215 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+#include "xynet/socket/proxy.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <chrono>
+#include <stop_token>
+#include <string>
+#include <limits>
+#include <unistd.h>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto listen_on_loopback()
+{
+  auto s = socket_t{};
+  s.init();
+  s.bind(socket_address{"127.0.0.1", 0});
+  s.listen();
+  return s;
+}
+
+/// \brief connect a new socket to listen_socket, return the connected socket and the accepted one.
+auto connected_pair(socket_t& listen_socket) -> task<pair<socket_t, socket_t>>
+{
+  auto client = socket_t{};
+  auto peer = socket_t{};
+  client.init();
+  co_await when_all(
+    client.connect(listen_socket.get_local_address()),
+    listen_socket.accept(peer)
+  );
+  co_return pair{std::move(client), std::move(peer)};
+}
+
+}
+
+TEST_CASE("splice" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+  auto listen_socket = listen_on_loopback();
+
+  SUBCASE("splice_to: socket to socket")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto [c, d] = co_await connected_pair(listen_socket);
+
+      // a -> b ~> c -> d
+      auto msg = string(1024 * 1024, 'x');
+      auto relay = [&]() -> task<size_t>
+      {
+        co_return co_await b.splice_to(c, msg.size());
+      };
+      auto sender = [&]() -> task<>
+      {
+        co_await a.send(span{msg});
+      };
+      auto receiver = [&]() -> task<string>
+      {
+        auto buf = string(msg.size(), '\0');
+        co_await d.recv(span{buf});
+        co_return buf;
+      };
+
+      auto [relayed, _, received] = co_await when_all(relay(), sender(), receiver());
+      CHECK(relayed == msg.size());
+      CHECK(received == msg);
+      CHECK(b.splice_buffered_bytes() == 0);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("splice_to: stops at EOF")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto [c, d] = co_await connected_pair(listen_socket);
+
+      co_await a.send(span{"xynet", 5});
+      a.shutdown();
+
+      auto relayed = co_await b.splice_to(c, numeric_limits<size_t>::max());
+      CHECK(relayed == 5);
+
+      array<char, 5> buf{};
+      co_await d.recv(buf);
+      CHECK(string_view{buf.data(), buf.size()} == "xynet");
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("splice_to: bytes left in the pipe do not exceed len")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto [c, d] = co_await connected_pair(listen_socket);
+      auto [e, f] = co_await connected_pair(listen_socket);
+
+      // the splice into c fails, so the bytes stay in the pipe of b.
+      co_await a.send(span{"0123456789", 10});
+      c.shutdown(SHUT_WR);
+      auto error = std::error_code{};
+      auto relayed = co_await b.splice_to(c, 10, error);
+      CHECK(error);
+      CHECK(relayed == 0);
+      REQUIRE(b.splice_buffered_bytes() == 10);
+
+      relayed = co_await b.splice_to(e, 3);
+      CHECK(relayed == 3);
+      CHECK(b.splice_buffered_bytes() == 7);
+      relayed = co_await b.splice_to(e, 7);
+      CHECK(relayed == 7);
+      CHECK(b.splice_buffered_bytes() == 0);
+
+      array<char, 10> buf{};
+      co_await f.recv(buf);
+      CHECK(string_view{buf.data(), buf.size()} == "0123456789");
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("splice_to: an idle socket times out")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [a, b] = co_await connected_pair(listen_socket);
+      auto [c, d] = co_await connected_pair(listen_socket);
+
+      // b waits for POLLIN, which the linked timeout cancels.
+      auto error = std::error_code{};
+      auto relayed = co_await b.splice_to(c, 5, chrono::milliseconds{50}, error);
+      CHECK(relayed == 0);
+      CHECK(error == std::errc::operation_canceled);
+
+      co_await a.send(span{"xynet", 5});
+      relayed = co_await b.splice_to(c, 5);
+      CHECK(relayed == 5);
+
+      array<char, 5> buf{};
+      co_await d.recv(buf);
+      CHECK(string_view{buf.data(), buf.size()} == "xynet");
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+
+  SUBCASE("proxy")
+  {
+    auto test = [&]() -> task<>
+    {
+      auto [client, proxy_a] = co_await connected_pair(listen_socket);
+      auto [proxy_b, server] = co_await connected_pair(listen_socket);
+
+      auto request  = string(200 * 1000, 'q');
+      auto response = string(300 * 1000, 'r');
+
+      auto client_session = [&]() -> task<string>
+      {
+        co_await client.send(span{request});
+        client.shutdown();
+        auto buf = string(response.size(), '\0');
+        co_await client.recv(span{buf});
+        co_return buf;
+      };
+
+      auto server_session = [&]() -> task<string>
+      {
+        auto buf = string(request.size(), '\0');
+        co_await server.recv(span{buf});
+        co_await server.send(span{response});
+        server.shutdown();
+        co_return buf;
+      };
+
+      auto [result, client_received, server_received]
+        = co_await when_all(proxy(proxy_a, proxy_b), client_session(), server_session());
+
+      CHECK(result.forwarded_bytes == request.size());
+      CHECK(result.backward_bytes  == response.size());
+      CHECK(client_received == response);
+      CHECK(server_received == request);
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
@@ -0,0 +1,17 @@
+#ifndef XYNET_TEST_TEST_UTIL_H
+#define XYNET_TEST_TEST_UTIL_H
+
+#include <stop_token>
+
+#include "xynet/io_service.h"
+#include "xynet/coroutine/task.h"
+
+/// \brief run service on the thread of the test until token is stopped, as a task to be
+///        awaited along with the test by when_all().
+inline auto run_service(xynet::io_service& service, std::stop_token token) -> xynet::task<>
+{
+  service.run(token);
+  co_return;
+}
+
+#endif //XYNET_TEST_TEST_UTIL_H
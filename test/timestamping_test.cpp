@@ -0,0 +1,81 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <chrono>
+#include <stop_token>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("SO_TIMESTAMPING" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+
+  auto client = socket_t{};
+  auto peer = socket_t{};
+  client.init();
+
+  auto test = [&]() -> task<>
+  {
+    co_await when_all(client.connect(listen_socket.get_local_address()), listen_socket.accept(peer));
+
+    array<char, 4> buf{};
+
+    SUBCASE("rx")
+    {
+      co_await client.send(span{"ping", 4});
+      auto untimed = co_await peer.recv_some_timestamped(buf);
+      CHECK(untimed.bytes == 4);
+      CHECK(!untimed.kernel_time);
+
+      peer.enable_timestamping({.rx = true, .tx_sent = false});
+      co_await client.send(span{"pong", 4});
+      auto timed = co_await peer.recv_some_timestamped(buf);
+      auto now = chrono::system_clock::now();
+      CHECK(timed.bytes == 4);
+      REQUIRE(timed.kernel_time);
+      CHECK(*timed.kernel_time <= now);
+      CHECK(now - *timed.kernel_time < chrono::seconds{1});
+    }
+
+    SUBCASE("tx")
+    {
+      client.enable_timestamping({.rx = false, .tx_sent = true, .tx_acked = true});
+      co_await client.send(span{"ping", 4});
+      co_await peer.recv(buf);
+      // the ack timestamp comes with the ack of the peer.
+      co_await service.schedule(chrono::milliseconds{50});
+
+      auto timestamps = client.tx_timestamps();
+      REQUIRE(timestamps.size() == 2);
+      for(auto& ts : timestamps)
+      {
+        // the id of a TCP send is the offset of its last byte.
+        CHECK(ts.id == 3);
+        CHECK(chrono::system_clock::now() - ts.time < chrono::seconds{1});
+      }
+      CHECK(timestamps[0].type == tx_timestamp_type::sent);
+      CHECK(timestamps[1].type == tx_timestamp_type::acked);
+      CHECK(client.tx_timestamps().empty());
+    }
+
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
@@ -0,0 +1,77 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <array>
+#include <chrono>
+#include <stop_token>
+
+using namespace xynet;
+using namespace std;
+
+TEST_CASE("transport stats" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  auto listen_socket = socket_t{};
+  listen_socket.init();
+  listen_socket.bind(socket_address{"127.0.0.1", 0});
+  listen_socket.listen();
+
+  auto client = socket_t{};
+  auto peer = socket_t{};
+  client.init();
+
+  auto test = [&]() -> task<>
+  {
+    co_await when_all(client.connect(listen_socket.get_local_address()), listen_socket.accept(peer));
+
+    array<char, 4> buf{};
+    co_await client.send(span{"ping", 4});
+    co_await client.send(span{"pong", 4});
+    co_await peer.recv(buf);
+    co_await peer.recv_some(buf);
+
+    CHECK(client.transport_stats().bytes_sent == 8);
+    CHECK(client.transport_stats().sends == 2);
+    CHECK(client.transport_stats().recvs == 0);
+    CHECK(peer.transport_stats().bytes_received == 8);
+    CHECK(peer.transport_stats().recvs == 2);
+    CHECK(peer.idle_time(service) == chrono::nanoseconds::zero());
+
+    auto info = client.tcp_info();
+    CHECK(info.rtt > chrono::microseconds::zero());
+    CHECK(info.cwnd > 0);
+    CHECK(info.snd_mss > 0);
+    CHECK(info.unacked == 0);
+
+    auto samples = 0;
+    auto sample_source = stop_source{};
+    co_await client.sample_tcp_info(chrono::milliseconds{1}, sample_source.get_token(),
+      [&](const tcp_info_sample& sample)
+      {
+        CHECK(sample.cwnd > 0);
+        if(++samples == 3)
+        {
+          sample_source.request_stop();
+        }
+      });
+    CHECK(samples == 3);
+
+    auto error = std::error_code{};
+    listen_socket.tcp_info(error);
+    CHECK(!error);
+
+    source.request_stop();
+  };
+
+  sync_wait(when_all(test(), run_service(service, source.get_token())));
+}
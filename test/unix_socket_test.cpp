@@ -0,0 +1,208 @@
+#include "doctest/doctest.h"
+
+#include "xynet/io_service.h"
+#include "xynet/socket/socket.h"
+
+#include "xynet/coroutine/task.h"
+#include "xynet/coroutine/when_all.h"
+#include "xynet/coroutine/sync_wait.h"
+
+#include "test_util.h"
+
+#include <stop_token>
+#include <string_view>
+#include <vector>
+#include <unistd.h>
+
+using namespace xynet;
+using namespace std;
+
+namespace
+{
+
+auto unique_abstract_address(string_view name)
+{
+  return unix_socket_address{"@xynet-" + string{name} + "-" + to_string(::getpid())};
+}
+
+}
+
+TEST_CASE("unix_socket_address")
+{
+  SUBCASE("path")
+  {
+    auto address = unix_socket_address{"/tmp/xynet.sock"};
+    CHECK(!address.is_abstract());
+    CHECK(address.to_str() == "/tmp/xynet.sock");
+    CHECK(address.size() == offsetof(::sockaddr_un, sun_path) + sizeof("/tmp/xynet.sock"));
+  }
+
+  SUBCASE("abstract")
+  {
+    auto address = unix_socket_address{"@xynet"};
+    CHECK(address.is_abstract());
+    CHECK(address.to_str() == "@xynet");
+    CHECK(address.size() == offsetof(::sockaddr_un, sun_path) + 6);
+  }
+}
+
+TEST_CASE("unix domain sockets" * doctest::timeout(10.0))
+{
+  auto service = io_service{};
+  auto source = stop_source{};
+
+  SUBCASE("stream: send / recv / fd passing")
+  {
+    auto address = unique_abstract_address("stream");
+    auto listen_socket = unix_stream_socket_t{};
+    listen_socket.init();
+    listen_socket.bind(address);
+    listen_socket.listen();
+
+    int pipe_fds[2];
+    REQUIRE(::pipe(pipe_fds) == 0);
+
+    auto server = [&]() -> task<>
+    {
+      auto peer = unix_stream_socket_t{};
+      co_await listen_socket.accept(peer);
+
+      array<char, 5> buf{};
+      co_await peer.recv(buf);
+      CHECK(string_view{buf.data(), buf.size()} == "xynet");
+
+      // pass the write end of the pipe to the client.
+      auto fds = array<int, 1>{pipe_fds[1]};
+      auto sent_bytes = co_await peer.send_fds(span<const int>{fds}, span{"!", 1});
+      CHECK(sent_bytes == 1);
+      peer.shutdown();
+      co_await peer.close();
+    };
+
+    auto client = [&]() -> task<>
+    {
+      auto s = unix_stream_socket_t{};
+      s.init();
+      co_await s.connect(address);
+      co_await s.send(span{"xynet", 5});
+
+      auto fds = array<int, 4>{-1, -1, -1, -1};
+      array<char, 1> buf{};
+      auto [bytes, fd_count] = co_await s.recv_fds(span<int>{fds}, buf);
+      CHECK(bytes == 1);
+      REQUIRE(fd_count == 1);
+      CHECK(fds[0] >= 0);
+      CHECK(fds[0] != pipe_fds[1]);
+
+      // the received fd refers to the same pipe.
+      CHECK(::write(fds[0], "ok", 2) == 2);
+      char pipe_buf[2];
+      CHECK(::read(pipe_fds[0], pipe_buf, 2) == 2);
+      CHECK(string_view{pipe_buf, 2} == "ok");
+      ::close(fds[0]);
+      s.shutdown();
+      co_await s.close();
+    };
+
+    auto test = [&]() -> task<>
+    {
+      co_await when_all(server(), client());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+  }
+
+  SUBCASE("stream: fd passing errors")
+  {
+    auto address = unique_abstract_address("stream-errors");
+    auto listen_socket = unix_stream_socket_t{};
+    listen_socket.init();
+    listen_socket.bind(address);
+    listen_socket.listen();
+
+    int pipe_fds[2];
+    REQUIRE(::pipe(pipe_fds) == 0);
+
+    auto server = [&]() -> task<>
+    {
+      auto peer = unix_stream_socket_t{};
+      co_await listen_socket.accept(peer);
+
+      // more than max_passed_fds are refused, rather than only some of them being passed.
+      auto too_many = vector<int>(max_passed_fds + 1, pipe_fds[1]);
+      auto error = std::error_code{};
+      auto sent_bytes = co_await peer.send_fds(error, span<const int>{too_many}, span{"!", 1});
+      CHECK(error == std::errc::invalid_argument);
+      CHECK(sent_bytes == 0);
+
+      auto fds = array<int, 3>{pipe_fds[1], pipe_fds[1], pipe_fds[1]};
+      co_await peer.send_fds(span<const int>{fds}, span{"!", 1});
+      peer.shutdown();
+      co_await peer.close();
+    };
+
+    auto client = [&]() -> task<>
+    {
+      auto s = unix_stream_socket_t{};
+      s.init();
+      co_await s.connect(address);
+
+      // three are passed, but only one fits.
+      auto fds = array<int, 1>{-1};
+      array<char, 1> buf{};
+      auto error = std::error_code{};
+      auto [bytes, fd_count] = co_await s.recv_fds(error, span<int>{fds}, buf);
+      CHECK(error == std::errc::message_size);
+      CHECK(bytes == 1);
+      CHECK(fd_count == 0);
+      CHECK(fds[0] == -1);
+      s.shutdown();
+      co_await s.close();
+    };
+
+    auto test = [&]() -> task<>
+    {
+      co_await when_all(server(), client());
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+    ::close(pipe_fds[0]);
+    ::close(pipe_fds[1]);
+  }
+
+  SUBCASE("datagram: connected send / recv_some")
+  {
+    auto a_address = unique_abstract_address("dgram-a");
+    auto b_address = unique_abstract_address("dgram-b");
+
+    auto a = unix_datagram_socket_t{};
+    a.init();
+    a.bind(a_address);
+    auto b = unix_datagram_socket_t{};
+    b.init();
+    b.bind(b_address);
+
+    auto test = [&]() -> task<>
+    {
+      co_await a.connect(b_address);
+      co_await b.connect(a_address);
+
+      co_await a.send(span{"ping", 4});
+      array<char, 16> buf{};
+      auto recv_bytes = co_await b.recv_some(buf);
+      CHECK(string_view{buf.data(), recv_bytes} == "ping");
+
+      co_await b.send(span{"pong", 4});
+      recv_bytes = co_await a.recv_some(buf);
+      CHECK(string_view{buf.data(), recv_bytes} == "pong");
+
+      source.request_stop();
+    };
+
+    sync_wait(when_all(test(), run_service(service, source.get_token())));
+  }
+}
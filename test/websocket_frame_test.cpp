@@ -4,6 +4,7 @@
 #include "doctest/doctest.h"
 #include "xynet/buffer.h"
 #include "xynet/http/websocket_frame_header.h"
+#include "xynet/mirrored_ring_buffer.h"
 
 using namespace xynet;
 
@@ -87,4 +88,25 @@ TEST_CASE("websocket frame header test2")
     CHECK_EQ(flags, parser.flags());
     CHECK_EQ(length, parser.length());
   }  
-}
\ No newline at end of file
+}
+TEST_CASE("websocket frame header across the wrap point of a mirrored_ring_buffer")
+{
+  auto flags  = websocket_flags::WS_FIN | websocket_flags::WS_HAS_MASK;
+  auto length = size_t{0xffffu + 1};
+
+  auto header = websocket_frame_header{flags, length};
+  auto header_length = header.span().size();
+
+  auto ring = mirrored_ring_buffer{1};
+  ring.commit(ring.capacity() - header_length / 2);
+  ring.consume(ring.capacity() - header_length / 2);
+
+  auto writable = ring.prepare(header_length);
+  std::copy(header.span().begin(), header.span().end(), writable.begin());
+  ring.commit(header_length);
+
+  auto parser = websocket_frame_header_parser{};
+  CHECK_EQ(parser.parse(ring.data()), header_length);
+  CHECK_EQ(flags, parser.flags());
+  CHECK_EQ(length, parser.length());
+}